@@ -0,0 +1,162 @@
+#include <cmath>
+#include <algorithm>
+#include "space.h"
+#include "solver.h"
+
+static unsigned int asymptoticThreshold = 0;
+
+// Alphabet sizes from which the surface areas are evaluated by the large-alphabet
+// solver instead of the selected one (0 turns the mode off).
+void SetAsymptoticThreshold(unsigned int threshold)
+{
+	asymptoticThreshold = threshold;
+}
+
+unsigned int GetAsymptoticThreshold()
+{
+	return asymptoticThreshold;
+}
+
+bool UsesAsymptotic(unsigned int alphabetSize)
+{
+	return asymptoticThreshold && alphabetSize >= asymptoticThreshold;
+}
+
+// For large alphabets the Gibbs distribution of the entropy subproblem is, for
+// the Lee metric, a discretized exponential over the weights 0, ..., q/2: its
+// partition function and moments are geometric sums with closed forms, so
+// SolveMultiplier finds the multiplier at a cost that does not depend on q. For the
+// Hamming metric the solution is the q-ary entropy function.
+class AsymptoticSurfaceSolver : public SurfaceSolver
+{
+private:
+	// log((1 - exp(-x)) / x)
+	static double LogRatio(double x)
+	{
+		if (x < 0)
+			return -x + LogRatio(-x);
+		if (x < 1e-8)
+			return -x / 2;
+		return log(-expm1(-x) / x);
+	}
+	// 1 / (exp(x) - 1) - 1 / x and its derivative, 1 / x^2 - 1 / (4 sinh^2(x / 2))
+	static double MeanShift(double x)
+	{
+		if (std::abs(x) < 1e-4)
+			return -0.5 + x / 12 - x * x * x / 720;
+		return 1 / expm1(x) - 1 / x;
+	}
+	static double VarianceShift(double x)
+	{
+		if (std::abs(x) < 1e-2)
+			return 1.0 / 12 - x * x / 240 + x * x * x * x / 6048;
+		double s = sinh(x / 2);
+		return 1 / (x * x) - 1 / (4 * s * s);
+	}
+	// Moments of the weights 0, ..., n, each of them counted once, under exp(-lambda * weight).
+	static Moments Geometric(unsigned int n, double lambda)
+	{
+		double size = n + 1.0;
+		Moments m;
+		m.logPartition = log(size) + LogRatio(lambda * size) - LogRatio(lambda);
+		m.mean = MeanShift(lambda) - size * MeanShift(lambda * size);
+		m.variance = std::max(0.0, size * size * VarianceShift(lambda * size) - VarianceShift(lambda));
+		return m;
+	}
+	// The Lee weights are 0, ..., maxWeight counted once plus 1, ..., maxWeight
+	// counted once more for odd alphabet sizes and 1, ..., maxWeight - 1 for even ones.
+	static Moments Gibbs(unsigned int alphabetSize, double lambda)
+	{
+		unsigned int maxWeight = alphabetSize / 2;
+		Moments a = Geometric(maxWeight, lambda);
+		if (alphabetSize < 3)
+			return a;
+
+		Moments b = Geometric(alphabetSize % 2 ? maxWeight - 1 : maxWeight - 2, lambda);
+		b.logPartition -= lambda;
+		b.mean += 1;
+
+		double share = 1 / (1 + exp(a.logPartition - b.logPartition));
+		double gap = a.mean - b.mean;
+		Moments m;
+		m.logPartition = std::max(a.logPartition, b.logPartition) + log1p(exp(-std::abs(a.logPartition - b.logPartition)));
+		m.mean = (1 - share) * a.mean + share * b.mean;
+		m.variance = (1 - share) * a.variance + share * b.variance + share * (1 - share) * gap * gap;
+		return m;
+	}
+	static double HammingArea(unsigned int alphabetSize, double distance)
+	{
+		double entropy = distance * log(alphabetSize - 1.0);
+		if (distance > 0 && distance < 1)
+			entropy -= distance * log(distance) + (1 - distance) * log1p(-distance);
+		return entropy / log(alphabetSize);
+	}
+public:
+	std::string GetName() const { return "asymptotic"; }
+	double SphereSurfArea(const VectorSpace& space, double distance) const
+	{
+		if (!ParamCheck(distance))
+			return -1;
+
+		unsigned int alphabetSize = space.GetAlphabetSize();
+		if (!space.GetMetric().compare("hamming"))
+			return HammingArea(alphabetSize, distance);
+
+		unsigned int maxWeight = MaxWeight(space);
+		double target = distance * maxWeight;
+		double logSize = log(alphabetSize);
+		if (target <= 0)
+			return 0;
+		if (target >= maxWeight)
+			return alphabetSize % 2 ? log(2.0) / logSize : 0;
+
+		Moments m;
+		double lambda = SolveMultiplier([&](double l) {return Gibbs(alphabetSize, l); }, target, maxWeight, m);
+		return std::max(0.0, m.logPartition + lambda * m.mean) / logSize;
+	}
+};
+
+const SurfaceSolver& AsymptoticSolver()
+{
+	static AsymptoticSurfaceSolver asymptotic;
+	return asymptotic;
+}
+
+// The exact solver the large-alphabet one is measured against: the selected
+// solver, or the native one when the large-alphabet solver is selected itself.
+const SurfaceSolver& AsymptoticReference()
+{
+	if (&GetSolver() != &AsymptoticSolver())
+		return GetSolver();
+
+	std::vector<const SurfaceSolver*> solvers = Solvers();
+	for (auto i = 0; i < solvers.size(); i++)
+	{
+		if (!solvers[i]->GetName().compare("native"))
+			return *solvers[i];
+	}
+	return GetSolver();
+}
+
+// Estimates the error of the large-alphabet solver by its largest deviation
+// from AsymptoticReference() over pointsNum distances evenly spread over
+// [0, 1], measured at the threshold (capped at maxCalibrationSize, since the
+// exact solvers take time linear in q). It is not a bound on the error at the
+// other alphabet sizes.
+double AsymptoticErrorEstimate(const std::string& metric, unsigned int pointsNum)
+{
+	const unsigned int maxCalibrationSize = 1 << 14;
+	VectorSpace space(metric, std::min(std::max(asymptoticThreshold, 2u), maxCalibrationSize));
+	const SurfaceSolver& reference = AsymptoticReference();
+
+	double maxDiff = 0;
+	for (auto i = 0; i < pointsNum; i++)
+	{
+		double distance = pointsNum > 1 ? double(i) / (pointsNum - 1) : 0.5;
+		double exact = reference.SphereSurfArea(space, distance);
+		if (exact == -1)
+			continue;
+		maxDiff = std::max(maxDiff, std::abs(AsymptoticSolver().SphereSurfArea(space, distance) - exact));
+	}
+	return maxDiff;
+}
@@ -1,5 +1,8 @@
 #include "isd.h"
+#include "progress.h"
 #include <algorithm>
+#include <cmath>
+#include <iostream>
 #include <boost/math/tools/roots.hpp>
 
 using boost::math::tools::bisect;
@@ -7,6 +10,7 @@ using boost::math::tools::bisect;
 const double tol = 1e-5;
 const double epsilon = 1e-5;
 bool quantum = false;
+std::atomic<unsigned long long> costModelEvals(0);
 
 InformationSetDecoding::InformationSetDecoding(unsigned int as, double cr, double w,
                                                const std::string& m, const std::string& a)
@@ -224,6 +228,8 @@ double InformationSetDecoding::AnySolProb(double paramL, double paramP) const
 
 double InformationSetDecoding::RunTime(double paramL, double paramP, unsigned int& optLevelNum) const
 {
+    costModelEvals++;
+
     double distance1 = paramP / (codeRate + paramL);
     if(!ParamCheck(distance1))
     {
@@ -264,6 +270,14 @@ double InformationSetDecoding::RunTime(double paramL, double paramP, unsigned in
         throw std::invalid_argument("Surface area surface2 is not found.");
     }
 
+    return RunTimeFromSurfaces(paramL, surface1, surface2, optLevelNum);
+}
+
+// Cost model given the surface areas of the spheres of radius paramP in the
+// first codeRate + paramL positions and of radius weight - paramP in the rest.
+double InformationSetDecoding::RunTimeFromSurfaces(double paramL, double surface1, double surface2,
+    unsigned int& optLevelNum) const
+{
     auto theorem = [=](unsigned int optLevelNum) -> bool
     {
         return bool(paramL <= optLevelNum / pow(2.0, optLevelNum) * surface1);
@@ -304,59 +318,58 @@ double InformationSetDecoding::RunTime(double paramL, double paramP, unsigned in
     }
 }
 
-double InformationSetDecoding::GoldenSectionSearch(double& paramP, unsigned int& optLevelNum)
+double InformationSetDecoding::GoldenSectionSearch(double& paramP, unsigned int& optLevelNum, const SearchStage& stage)
 {
     double paramPLow = std::max(0.0, weight - (1 - codeRate));
     double paramPHigh = std::min(weight, codeRate);
-    std::function<double(double)> runTimeFun = [&](double p) {return RunTime(0.0, p, optLevelNum); };
-    paramP = ::GoldenSectionSearch(paramPLow, paramPHigh, tol, runTimeFun);
+    std::function<double(double)> runTimeFun = [&](double p)
+    {
+        unsigned int levelNum;
+        return RunTime(0.0, p, levelNum);
+    };
+    paramP = ::GoldenSectionSearch(paramPLow, paramPHigh, stage.innerTol, runTimeFun, stage.guessP, stage.radius,
+        searchProgress.Monitor(SearchProgress::ParamPLevel));
     
     return log2(alphabetSize) * RunTime(0.0, paramP, optLevelNum);
 }
 
-double InformationSetDecoding::GoldenSectionSearch(double& paramL, double& paramP, unsigned int& optLevelNum)
+double InformationSetDecoding::GoldenSectionSearch(double& paramL, double& paramP, unsigned int& optLevelNum,
+    const SearchStage& stage)
 {
     const double paramLLow = 0, paramLHigh = 1 - codeRate;
-    double a = paramLLow, b = paramLHigh;
-    const double gr = (sqrt(5) + 1) / 2;
-    double c = b - (b - a) / gr;
-    double d = a + (b - a) / gr;
-
-    while (std::abs(c - d) > tol)
+    BracketMonitor monitorL = searchProgress.Monitor(SearchProgress::ParamLLevel);
+    BracketMonitor monitorP = searchProgress.Monitor(SearchProgress::ParamPLevel);
+    std::function<double(double)> runTimeL = [&](double l)
     {
-        double paramPLowC = std::max(0.0, weight - (1 - codeRate - c));
-        double paramPHighC = std::min(weight, codeRate + c);
-        std::function<double(double)> runTimeC = [&](double p) {return RunTime(c, p, optLevelNum); };
-        double optC = ::GoldenSectionSearch(paramPLowC, paramPHighC, tol, runTimeC);
-
-        double paramPLowD = std::max(0.0, weight - (1 - codeRate - d));
-        double paramPHighD = std::min(weight, codeRate + d);
-        std::function<double(double)> runTimeD = [&](double p) {return RunTime(d, p, optLevelNum); };
-        double optD = ::GoldenSectionSearch(paramPLowD, paramPHighD, tol, runTimeD);
-
-        if (RunTime(c, optC, optLevelNum) < RunTime(d, optD, optLevelNum))
+        std::function<double(double)> runTimeP = [&](double p)
         {
-            b = d;
-        }
-        else
-        {
-            a = c;
-        }
-        c = b - (b - a) / gr;
-        d = a + (b - a) / gr;
-    }
+            unsigned int levelNum;
+            return RunTime(l, p, levelNum);
+        };
+        double optP = ::GoldenSectionSearch(std::max(0.0, weight - (1 - codeRate - l)),
+            std::min(weight, codeRate + l), stage.innerTol, runTimeP, stage.guessP, stage.radius, monitorP);
+        unsigned int levelNum;
+        return RunTime(l, optP, levelNum);
+    };
+    paramL = ::GoldenSectionSearch(paramLLow, paramLHigh, stage.innerTol, runTimeL, stage.guessL, stage.radius,
+        monitorL);
 
-    paramL = (b + a) / 2;
-    std::function<double(double)> runTime = [&](double p) {return RunTime(paramL, p, optLevelNum); };
+    std::function<double(double)> runTime = [&](double p)
+    {
+        unsigned int levelNum;
+        return RunTime(paramL, p, levelNum);
+    };
     paramP = ::GoldenSectionSearch(std::max(0.0, weight - (1 - codeRate - paramL)),
-        std::min(weight, codeRate + paramL), tol, runTime);
+        std::min(weight, codeRate + paramL), stage.innerTol, runTime, stage.guessP, stage.radius, monitorP);
 
     return log2(alphabetSize) * RunTime(paramL, paramP, optLevelNum);
 }
 
 struct TerminationCondition {
+    double rootTol;
+    TerminationCondition(double t = tol) : rootTol(t) {}
     bool operator() (double min, double max) {
-        return std::abs(min - max) <= tol;
+        return std::abs(min - max) <= rootTol;
     }
 };
 
@@ -371,11 +384,11 @@ double AvgSolsNum(const VectorSpace& space, double distance, double codeRate)
     return surface - (1 - codeRate);
 }
 
-double UpperRoot(std::string metric, unsigned int alphabetSize, double codeRate)
+double UpperRoot(std::string metric, unsigned int alphabetSize, double codeRate, double rootTol)
 {
     VectorSpace space(metric, alphabetSize);
     std::function<double(double)> avgSolsNumCR = [&](double cr) {return AvgSolsNum(space, 1 - epsilon, cr); };
-    std::pair<double, double> bracketsCR = bisect(avgSolsNumCR, 0.0, 1.0, TerminationCondition());
+    std::pair<double, double> bracketsCR = bisect(avgSolsNumCR, 0.0, 1.0, TerminationCondition(rootTol));
     double highestCodeRate = (bracketsCR.first + bracketsCR.second) / 2;
 
     if (codeRate > highestCodeRate)
@@ -383,34 +396,39 @@ double UpperRoot(std::string metric, unsigned int alphabetSize, double codeRate)
     else
     {
         std::function<double(double)> avgSolsNumW = [&](double w) {return AvgSolsNum(space, w, codeRate); };
-        std::pair<double, double> bracketsW = bisect(avgSolsNumW, AvgVectorWeight(space, 1.0) / MaxWeight(space), 1.0, TerminationCondition());
+        std::pair<double, double> bracketsW = bisect(avgSolsNumW, AvgVectorWeight(space, 1.0) / MaxWeight(space), 1.0, TerminationCondition(rootTol));
         return (bracketsW.first + bracketsW.second) / 2;
     }
 }
 
-double LowerRoot(std::string metric, unsigned int alphabetSize, double codeRate)
+double LowerRoot(std::string metric, unsigned int alphabetSize, double codeRate, double rootTol)
 {
     VectorSpace space(metric, alphabetSize);
     std::function<double(double)> avgSolsNumW = [&](double w) {return AvgSolsNum(space, w, codeRate); };
-    std::pair<double, double> bracketsW = bisect(avgSolsNumW, 0.0, AvgVectorWeight(space, 1.0) / MaxWeight(space), TerminationCondition());
+    std::pair<double, double> bracketsW = bisect(avgSolsNumW, 0.0, AvgVectorWeight(space, 1.0) / MaxWeight(space), TerminationCondition(rootTol));
     return (bracketsW.first + bracketsW.second) / 2;
 }
 
-double RunTime(std::string metric, std::string algorithm, unsigned int alphabetSize, double codeRate,
-    double& weight, double& paramL, double& paramP, unsigned int& optLevelNum)
+double HardestWeight(std::string metric, unsigned int alphabetSize, double codeRate, double rootTol)
 {
-    if(!MetricCheck(metric))
-        throw std::invalid_argument("This metric is not offered. Allowed metrics are hamming and lee.");
-
-    double runTime;
     if (!metric.compare("hamming") && (alphabetSize != 3 || alphabetSize !=2))
     {
-        weight = LowerRoot(metric, alphabetSize, codeRate) - epsilon;
+        return LowerRoot(metric, alphabetSize, codeRate, rootTol) - epsilon;
     }
     else
     {
-        weight = UpperRoot(metric, alphabetSize, codeRate) - epsilon;
+        return UpperRoot(metric, alphabetSize, codeRate, rootTol) - epsilon;
     }
+}
+
+double RunTime(std::string metric, std::string algorithm, unsigned int alphabetSize, double codeRate,
+    double& weight, double& paramL, double& paramP, unsigned int& optLevelNum, const SearchStage& stage)
+{
+    if(!MetricCheck(metric))
+        throw std::invalid_argument("This metric is not offered. Allowed metrics are hamming and lee.");
+
+    double runTime;
+    weight = HardestWeight(metric, alphabetSize, codeRate, stage.rootTol);
 
     InformationSetDecoding isd(alphabetSize, codeRate, weight, metric, algorithm);
     if (!algorithm.compare("prange"))
@@ -418,7 +436,7 @@ double RunTime(std::string metric, std::string algorithm, unsigned int alphabetS
         try
         {
             paramL = 0;
-            runTime = isd.GoldenSectionSearch(paramP, optLevelNum);
+            runTime = isd.GoldenSectionSearch(paramP, optLevelNum, stage);
         }
         catch (std::runtime_error& e)
         {
@@ -430,7 +448,7 @@ double RunTime(std::string metric, std::string algorithm, unsigned int alphabetS
     {
         try
         {
-            runTime = isd.GoldenSectionSearch(paramL, paramP, optLevelNum);
+            runTime = isd.GoldenSectionSearch(paramL, paramP, optLevelNum, stage);
         }
         catch (std::runtime_error& e)
         {
@@ -445,3 +463,148 @@ double RunTime(std::string metric, std::string algorithm, unsigned int alphabetS
     }
     return -runTime;
 }
+
+// Coarse-to-fine search for the hardest instance. Every stage tightens the
+// tolerance and restarts the outer code-rate search and the inner (L, P)
+// searches from brackets narrowed around the optimum of the previous stage.
+// A seeded code rate stands in for the stages whose narrowed bracket would be
+// at least as wide as the seeded one: the search starts at the first stage
+// that would narrow further, and starts over cold, forgetting the probes of
+// the seeded stage, if the seed misses.
+// The inner searches get a tenth of the outer tolerance (never less precise
+// than tol) since their error enters the outer comparisons through the kinks
+// of the cost model; the root bisections are cheap and always run at tol.
+// Every completed outer probe is reported to searchProgress; once its budget
+// expires, the search stops and returns its best-so-far point instead.
+double HardestInstance(std::string metric, std::string algorithm, unsigned int alphabetSize,
+    double& codeRate, double& weight, double& paramL, double& paramP, unsigned int& optLevelNum,
+    SearchStage seed)
+{
+    const double stageTols[] = { 1e-2, 1e-3, 1e-4, tol };
+    const unsigned int stagesNum = sizeof(stageTols) / sizeof(stageTols[0]);
+    const double margin = 10;
+
+    SearchStage stage = seed;
+    std::function<double(double)> runTimeFun = [&](double cr)
+    {
+        double w, l, p;
+        unsigned int levelNum;
+        double runTime = RunTime(metric, algorithm, alphabetSize, cr, w, l, p, levelNum, stage);
+        if (!searchProgress.Expired())
+            searchProgress.AddProbe(cr, w, l, p, levelNum, -runTime);
+        return runTime;
+    };
+
+    unsigned int firstStage = 0;
+    if (seed.codeRateRadius > 0)
+    {
+        while (firstStage + 1 < stagesNum && margin * stageTols[firstStage] >= seed.codeRateRadius)
+            firstStage++;
+    }
+
+    double runTime = 0;
+    unsigned int i = firstStage;
+    while (i < stagesNum && !searchProgress.Expired())
+    {
+        searchProgress.SetStage(i, stagesNum);
+        stage.outerTol = stageTols[i];
+        stage.innerTol = std::max(tol, stageTols[i] / 10);
+        stage.rootTol = tol;
+        BracketMonitor monitor = searchProgress.Monitor(SearchProgress::CodeRateLevel);
+        if (i > 0 && i == firstStage)
+        {
+            // The inner brackets are narrowed around the (L, P) of the seeded
+            // code rate, found at the precision of the skipped stage.
+            SearchStage skipped(tol);
+            skipped.innerTol = std::max(tol, stageTols[i - 1] / 10);
+            double w, l, p;
+            unsigned int levelNum;
+            RunTime(metric, algorithm, alphabetSize, stage.guessCodeRate, w, l, p, levelNum, skipped);
+            stage.guessL = l;
+            stage.guessP = p;
+            stage.radius = margin * stageTols[i - 1];
+
+            double low = std::max(epsilon, stage.guessCodeRate - stage.codeRateRadius);
+            double high = std::min(1.0 - epsilon, stage.guessCodeRate + stage.codeRateRadius);
+            codeRate = GoldenSectionSearch(low, high, stage.outerTol, runTimeFun, monitor);
+            if (OnNarrowedEdge(codeRate, low, high, epsilon, 1.0 - epsilon, stage.outerTol))
+            {
+                firstStage = i = 0;
+                stage = SearchStage();
+                searchProgress.ResetBest();
+                continue;
+            }
+        }
+        else
+        {
+            codeRate = GoldenSectionSearch(epsilon, 1.0 - epsilon, stage.outerTol, runTimeFun,
+                stage.guessCodeRate, stage.codeRateRadius, monitor);
+        }
+
+        runTime = RunTime(metric, algorithm, alphabetSize, codeRate, weight, paramL, paramP, optLevelNum, stage);
+        if (searchProgress.Expired())
+            break;
+        searchProgress.AddProbe(codeRate, weight, paramL, paramP, optLevelNum, -runTime);
+        searchProgress.SetStage(i + 1, stagesNum);
+        stage.guessCodeRate = codeRate;
+        stage.guessL = paramL;
+        stage.guessP = paramP;
+        stage.codeRateRadius = stage.radius = margin * stageTols[i];
+        i++;
+    }
+
+    if (!searchProgress.Complete())
+    {
+        if (!searchProgress.GetBest(codeRate, weight, paramL, paramP, optLevelNum, runTime))
+            throw std::runtime_error("The budget expired before any code rate was evaluated.");
+        runTime = -runTime;
+    }
+
+    return runTime;
+}
+
+// Returns the predicted code rate and sets step to its distance from the code
+// rate of the most recently solved size.
+double WarmStart::Extrapolate(unsigned int alphabetSize, double& step) const
+{
+    auto n = codeRates.size();
+    step = 0;
+    if (n >= 2 && logSizes[n - 1] != logSizes[n - 2])
+    {
+        step = (codeRates[n - 1] - codeRates[n - 2]) / (logSizes[n - 1] - logSizes[n - 2])
+            * (log(alphabetSize) - logSizes[n - 1]);
+    }
+    return std::min(1.0 - epsilon, std::max(epsilon, codeRates[n - 1] + step));
+}
+
+void WarmStart::Add(unsigned int alphabetSize, double codeRate)
+{
+    if (codeRates.size() >= 2)
+    {
+        double step;
+        lastError = codeRate - Extrapolate(alphabetSize, step);
+        hasError = true;
+    }
+    logSizes.push_back(log(alphabetSize));
+    codeRates.push_back(codeRate);
+}
+
+// Only the code-rate bracket is seeded: with Wagner's algorithm the inner cost
+// has a local minimum per tree depth, and (L, P) carried over from another
+// alphabet size can trap the inner searches away from the edges of their
+// narrowed brackets, where no fallback would catch it. Nothing is predicted
+// before the error of a prediction has been observed, since a missed seed
+// costs a whole stage; then the radius is twice the extrapolation step and
+// twice the error of the last prediction, but at least minRadius.
+bool WarmStart::Predict(unsigned int alphabetSize, SearchStage& seed) const
+{
+    const double minRadius = 1e-2;
+    if (!hasError)
+        return false;
+
+    double step;
+    seed.guessCodeRate = Extrapolate(alphabetSize, step);
+    seed.codeRateRadius = std::max(minRadius, 2 * std::max(std::abs(step), std::abs(lastError)));
+
+    return true;
+}
@@ -1,18 +1,53 @@
 #ifndef ISD_H
 #define ISD_H
 
+#include <atomic>
+#include <vector>
 #include "space.h"
 #include "misc.h"
 
 extern const double tol;
 extern const double epsilon;
 extern bool quantum;
+extern std::atomic<unsigned long long> costModelEvals;
+
+// One pass of the nested searches: tolerances of the outer code-rate search,
+// of the inner L and P searches and of the root bisections fixing the weight,
+// and the guesses around which the brackets are narrowed. A non-positive
+// radius keeps the full brackets.
+struct SearchStage
+{
+	double outerTol, innerTol, rootTol;
+	double guessCodeRate, codeRateRadius;
+	double guessL, guessP, radius;
+	SearchStage(double t = tol) : outerTol(t), innerTol(t), rootTol(t),
+		guessCodeRate(0.0), codeRateRadius(0.0), guessL(0.0), guessP(0.0), radius(0.0) {}
+};
+
+// Predicts the optimal code rate for the next alphabet size by extrapolating,
+// linearly in log(alphabetSize), the optima of the two most recently solved
+// sizes, and sizes the bracket around it from the error of the last prediction.
+class WarmStart
+{
+private:
+	std::vector<double> logSizes, codeRates;
+	double lastError;
+	bool hasError;
+	double Extrapolate(unsigned int, double&) const;
+public:
+	WarmStart() : lastError(0), hasError(false) {}
+	void Add(unsigned int, double);
+	bool Predict(unsigned int, SearchStage&) const;
+};
 
 double AvgSolsNum(const VectorSpace&, double, double);
-double UpperRoot(std::string, unsigned int, double);
-double LowerRoot(std::string, unsigned int, double);
+double UpperRoot(std::string, unsigned int, double, double = tol);
+double LowerRoot(std::string, unsigned int, double, double = tol);
+double HardestWeight(std::string, unsigned int, double, double = tol);
 double RunTime(std::string, std::string, unsigned int, double,
-			   double&, double&, double&, unsigned int&);
+			   double&, double&, double&, unsigned int&, const SearchStage& = SearchStage());
+double HardestInstance(std::string, std::string, unsigned int,
+			   double&, double&, double&, double&, unsigned int&, SearchStage = SearchStage());
 
 class InformationSetDecoding
 {
@@ -64,8 +99,9 @@ public:
 	double PartSolProb(double, double) const;
 	double AnySolProb(double, double) const;
 	double RunTime(double, double, unsigned int&) const;
-	double GoldenSectionSearch(double&, unsigned int&);
-	double GoldenSectionSearch(double&, double&, unsigned int&);
+	double RunTimeFromSurfaces(double, double, double, unsigned int&) const;
+	double GoldenSectionSearch(double&, unsigned int&, const SearchStage& = SearchStage());
+	double GoldenSectionSearch(double&, double&, unsigned int&, const SearchStage& = SearchStage());
 	// add Destructor
 };
 
@@ -0,0 +1,136 @@
+#include <fstream>
+#include <iomanip>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include "landscape.h"
+#include "parallel.h"
+
+SurfaceTable::SurfaceTable(const VectorSpace& vs, unsigned int size) : space(vs), areas(size)
+{
+	if (size == 1)
+		throw std::invalid_argument("Surface table needs at least 2 entries.");
+
+	ParallelFor(0, size, [&](unsigned int i)
+	{
+		areas[i] = space.SphereSurfArea((1 - cos(M_PI * i / (size - 1))) / 2);
+	});
+	if (std::find(areas.begin(), areas.end(), -1.0) != areas.end())
+	{
+		throw std::invalid_argument("Surface area of the surface table is not found.");
+	}
+}
+
+double SurfaceTable::operator()(double distance) const
+{
+	distance = std::min(1.0, std::max(0.0, distance));
+	if (areas.empty())
+	{
+		double area = space.SphereSurfArea(distance);
+		if (area == -1)
+		{
+			throw std::invalid_argument("Surface area of the landscape is not found.");
+		}
+		return area;
+	}
+
+	double position = acos(1 - 2 * distance) / M_PI * (areas.size() - 1);
+	auto i = std::min((unsigned int)position, (unsigned int)areas.size() - 2);
+	double frac = position - i;
+	return (1 - frac) * areas[i] + frac * areas[i + 1];
+}
+
+// Evaluates the cost model on rows x cols points of the feasible (L, P) region
+// of a code rate in (0, 1): row i has L = (i + 1/2) / rows * (1 - codeRate),
+// which keeps clear of L = 0 where Wagner's tree depth is unbounded, and spreads its columns evenly over
+// the feasible P for that L (Prange's algorithm has the single row L = 0).
+// Tiles of rows run in parallel, and each batch of tiles is written to the
+// file as soon as it is done, either as CSV or, for a .bin file, as a header
+// (rows, cols, alphabetSize as uint32, codeRate, weight as double) followed by
+// (L, P, runtime as double, optLevelNum as uint32) records.
+void ExportLandscape(const InformationSetDecoding& isd, unsigned int rows, unsigned int cols,
+	unsigned int tableSize, const std::string& filename)
+{
+	struct Point
+	{
+		double paramL, paramP, runTime;
+		unsigned int optLevelNum;
+	};
+	const unsigned int tileRows = 8;
+
+	double codeRate = isd.GetCodeRate(), weight = isd.GetWeight();
+	if (codeRate <= 0 || codeRate >= 1)
+		throw std::invalid_argument("The landscape needs a code rate strictly between 0 and 1.");
+	double scale = log2(isd.GetAlphaSize());
+	bool prange = !isd.GetAlg().compare("prange");
+	if (prange)
+		rows = 1;
+	bool binary = filename.size() >= 4 && !filename.compare(filename.size() - 4, 4, ".bin");
+
+	std::ofstream outputFile(filename, binary ? std::ofstream::out | std::ofstream::binary : std::ofstream::out);
+	if (!outputFile)
+		throw std::runtime_error("Landscape file " + filename + " cannot be opened.");
+
+	if (binary)
+	{
+		uint32_t sizes[] = { rows, cols, isd.GetAlphaSize() };
+		double params[] = { codeRate, weight };
+		outputFile.write((const char*)sizes, sizeof(sizes));
+		outputFile.write((const char*)params, sizeof(params));
+	}
+	else
+	{
+		outputFile << "# metric " << isd.GetMetric() << " algorithm " << isd.GetAlg() << " quantum " << quantum;
+		outputFile << " alphabetSize " << isd.GetAlphaSize() << " codeRate " << codeRate << " weight " << weight;
+		outputFile << " tableSize " << tableSize << std::endl;
+		outputFile << "paramL,paramP,optLevelNum,runtime(log 2)" << std::endl;
+		outputFile << std::setprecision(8);
+	}
+
+	SurfaceTable surfaces(isd.GetSpace(), tableSize);
+	const unsigned int batchRows = tileRows * 4 * threadsNum;
+	std::vector<Point> points;
+	for (auto first = 0u; first < rows; first += batchRows)
+	{
+		unsigned int last = std::min(rows, first + batchRows);
+		points.resize((last - first) * cols);
+		ParallelFor(0, (last - first + tileRows - 1) / tileRows, [&](unsigned int tile)
+		{
+			for (auto i = first + tile * tileRows; i < std::min(last, first + (tile + 1) * tileRows); i++)
+			{
+				double paramL = prange ? 0.0 : (1 - codeRate) * (i + 0.5) / rows;
+				double length1 = codeRate + paramL, length2 = 1 - codeRate - paramL;
+				double paramPLow = std::max(0.0, weight - length2), paramPHigh = std::min(weight, length1);
+				for (auto j = 0u; j < cols; j++)
+				{
+					Point& point = points[(i - first) * cols + j];
+					point.paramL = paramL;
+					point.paramP = cols > 1 ? paramPLow + (paramPHigh - paramPLow) * j / (cols - 1) : paramPLow;
+					double surface1 = length1 * surfaces(point.paramP / length1);
+					double surface2 = length2 * surfaces((weight - point.paramP) / length2);
+					point.runTime = scale * isd.RunTimeFromSurfaces(paramL, surface1, surface2, point.optLevelNum);
+				}
+			}
+		});
+
+		for (auto k = 0u; k < points.size(); k++)
+		{
+			if (binary)
+			{
+				uint32_t optLevelNum = points[k].optLevelNum;
+				outputFile.write((const char*)&points[k].paramL, sizeof(double));
+				outputFile.write((const char*)&points[k].paramP, sizeof(double));
+				outputFile.write((const char*)&points[k].runTime, sizeof(double));
+				outputFile.write((const char*)&optLevelNum, sizeof(uint32_t));
+			}
+			else
+			{
+				outputFile << points[k].paramL << "," << points[k].paramP << ",";
+				outputFile << points[k].optLevelNum << "," << points[k].runTime << "\n";
+			}
+		}
+	}
+
+	if (!outputFile)
+		throw std::runtime_error("Landscape file " + filename + " cannot be written.");
+}
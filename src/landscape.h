@@ -0,0 +1,24 @@
+#ifndef LANDSCAPE_H
+#define LANDSCAPE_H
+
+#include <vector>
+#include "isd.h"
+
+// Surface areas of the spheres of a vector space, solved once on a grid of
+// distances clustered towards 0 and 1, where the entropy is steepest, and
+// linearly interpolated in between. Every point of a landscape needs two
+// surface areas, so all of its rows and columns share the same table. A table
+// of size 0 calls the solver for every distance instead.
+class SurfaceTable
+{
+private:
+	VectorSpace space;
+	std::vector<double> areas;
+public:
+	SurfaceTable(const VectorSpace&, unsigned int);
+	double operator()(double) const;
+};
+
+void ExportLandscape(const InformationSetDecoding&, unsigned int, unsigned int, unsigned int, const std::string&);
+
+#endif
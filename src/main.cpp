@@ -6,9 +6,19 @@
 #include <chrono>
 #include <iomanip>
 #include <sstream>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
 #include "space.h"
 #include "isd.h"
 #include "misc.h"
+#include "parallel.h"
+#include "landscape.h"
+#include "solver.h"
+#include "progress.h"
+#include "regression.h"
+#include "sweep.h"
 
 std::vector<unsigned int> ParseAlphabetSizes(std::string str) {
 	std::stringstream ss = std::stringstream(str);
@@ -22,8 +32,183 @@ std::vector<unsigned int> ParseAlphabetSizes(std::string str) {
 	return v;
 }
 
-int main()
+std::vector<std::string> ParseNames(const std::string& str) {
+	std::stringstream ss = std::stringstream(str);
+	std::vector<std::string> v;
+	std::string name;
+	while (std::getline(ss, name, ','))
+		v.push_back(name);
+	return v;
+}
+
+// Inserts "_<alphabetSize>" before the extension of the landscape file when
+// several alphabet sizes are exported.
+std::string LandscapeFilename(const std::string& filename, unsigned int alphabetSize, bool suffix)
+{
+	if (!suffix)
+		return filename;
+
+	auto dot = filename.find_last_of('.');
+	auto slash = filename.find_last_of('/');
+	if (dot == std::string::npos || (slash != std::string::npos && slash > dot))
+		dot = filename.size();
+	return filename.substr(0, dot) + "_" + std::to_string(alphabetSize) + filename.substr(dot);
+}
+
+int main(int argc, char* argv[])
 {
+	bool warmStart = false;
+	unsigned int validationPoints = 0;
+	double timeBudget = 0, progressInterval = 10;
+	unsigned long long evalBudget = 0;
+	std::string landscapeFile;
+	double landscapeCodeRate = -1, landscapeWeight = -1;
+	unsigned int gridRows = 1000, gridCols = 1000, tableSize = 4097;
+	std::string regressionFile, recordFile;
+	std::vector<unsigned int> sweepSizes = { 3, 5, 7 };
+	double regressionTol = 1e-3;
+	std::string workDir, mergeDir;
+	unsigned int shard = 0, shardsNum = 1;
+	std::vector<std::string> sweepMetrics = { "hamming", "lee" }, sweepAlgorithms = { "prange", "dumer", "wagner" };
+	std::vector<std::string> sweepRegimes = { "classical", "quantum" };
+	for (auto i = 1; i < argc; i++)
+	{
+		std::string arg(argv[i]);
+		if (!arg.compare("--warm-start"))
+			warmStart = true;
+		else if (!arg.compare("--threads") && i + 1 < argc && std::atoi(argv[i + 1]) > 0)
+			threadsNum = std::atoi(argv[++i]);
+		else if (!arg.compare("--landscape") && i + 1 < argc)
+			landscapeFile = argv[++i];
+		else if (!arg.compare("--code-rate") && i + 1 < argc && std::atof(argv[i + 1]) > 0 && std::atof(argv[i + 1]) < 1)
+			landscapeCodeRate = std::atof(argv[++i]);
+		else if (!arg.compare("--weight") && i + 1 < argc && ParamCheck(std::atof(argv[i + 1])))
+			landscapeWeight = std::atof(argv[++i]);
+		else if (!arg.compare("--grid") && i + 1 < argc
+			&& sscanf(argv[i + 1], "%ux%u", &gridRows, &gridCols) == 2 && gridRows > 0 && gridCols > 0)
+			i++;
+		else if (!arg.compare("--table") && i + 1 < argc && (std::atoi(argv[i + 1]) == 0 || std::atoi(argv[i + 1]) >= 2))
+			tableSize = std::atoi(argv[++i]);
+		else if (!arg.compare("--solver") && i + 1 < argc)
+		{
+			try
+			{
+				SetSolver(argv[++i]);
+			}
+			catch (std::invalid_argument& ia)
+			{
+				std::cout << ia.what() << std::endl;
+				return -1;
+			}
+		}
+		else if (!arg.compare("--time-budget") && i + 1 < argc && std::atof(argv[i + 1]) > 0)
+			timeBudget = std::atof(argv[++i]);
+		else if (!arg.compare("--eval-budget") && i + 1 < argc && std::atoll(argv[i + 1]) > 0)
+			evalBudget = std::atoll(argv[++i]);
+		else if (!arg.compare("--progress") && i + 1 < argc && std::atof(argv[i + 1]) >= 0)
+			progressInterval = std::atof(argv[++i]);
+		else if (!arg.compare("--asymptotic") && i + 1 < argc && AlphabetSizeCheck(std::atoi(argv[i + 1])))
+			SetAsymptoticThreshold(std::atoi(argv[++i]));
+		else if (!arg.compare("--regression") && i + 1 < argc)
+			regressionFile = argv[++i];
+		else if (!arg.compare("--record-regression") && i + 1 < argc)
+			recordFile = argv[++i];
+		else if (!arg.compare("--sizes") && i + 1 < argc)
+			sweepSizes = ParseAlphabetSizes(argv[++i]);
+		else if (!arg.compare("--tolerance") && i + 1 < argc && std::atof(argv[i + 1]) > 0)
+			regressionTol = std::atof(argv[++i]);
+		else if (!arg.compare("--shard") && i + 1 < argc
+			&& sscanf(argv[i + 1], "%u/%u", &shard, &shardsNum) == 2 && shard < shardsNum)
+			i++;
+		else if (!arg.compare("--work-dir") && i + 1 < argc)
+			workDir = argv[++i];
+		else if (!arg.compare("--merge") && i + 1 < argc)
+			mergeDir = argv[++i];
+		else if (!arg.compare("--metric") && i + 1 < argc)
+			sweepMetrics = ParseNames(argv[++i]);
+		else if (!arg.compare("--algorithm") && i + 1 < argc)
+			sweepAlgorithms = ParseNames(argv[++i]);
+		else if (!arg.compare("--regime") && i + 1 < argc)
+			sweepRegimes = ParseNames(argv[++i]);
+		else if (!arg.compare("--validate-solvers") && i + 1 < argc && std::atoi(argv[i + 1]) > 0)
+			validationPoints = std::atoi(argv[++i]);
+		else
+		{
+			std::cout << "Unknown option: " << arg << std::endl;
+			return -1;
+		}
+	}
+	if (!landscapeFile.empty() && landscapeCodeRate < 0)
+	{
+		std::cout << "The landscape needs a code rate (--code-rate)." << std::endl;
+		return -1;
+	}
+
+	if (!recordFile.empty() || !regressionFile.empty())
+	{
+		try
+		{
+			if (!recordFile.empty())
+			{
+				RecordRegression(recordFile, sweepSizes, std::cout);
+				return 0;
+			}
+			return CheckRegression(regressionFile, regressionTol, std::cout) ? -1 : 0;
+		}
+		catch (std::runtime_error& rte)
+		{
+			std::cout << rte.what() << std::endl;
+			return -1;
+		}
+		catch (std::invalid_argument& ia)
+		{
+			std::cout << ia.what() << std::endl;
+			return -1;
+		}
+	}
+
+	if (!workDir.empty() || !mergeDir.empty())
+	{
+		for (auto i = 0; i < sweepMetrics.size(); i++)
+			if (!MetricCheck(sweepMetrics[i]))
+			{
+				std::cout << "This metric is not offered: " << sweepMetrics[i] << std::endl;
+				return -1;
+			}
+		for (auto i = 0; i < sweepAlgorithms.size(); i++)
+			if (!AlgCheck(sweepAlgorithms[i]))
+			{
+				std::cout << "This algorithm is not offered: " << sweepAlgorithms[i] << std::endl;
+				return -1;
+			}
+		for (auto i = 0; i < sweepRegimes.size(); i++)
+			if (sweepRegimes[i].compare("classical") && sweepRegimes[i].compare("quantum"))
+			{
+				std::cout << "This regime is not offered: " << sweepRegimes[i] << std::endl;
+				return -1;
+			}
+
+		try
+		{
+			if (!workDir.empty())
+				RunShard(SweepItems(sweepMetrics, sweepAlgorithms, sweepRegimes, sweepSizes), shard, shardsNum, workDir,
+					SweepBudget(timeBudget, evalBudget, progressInterval), std::cout);
+			if (!mergeDir.empty())
+				MergeShards(mergeDir, std::cout);
+		}
+		catch (std::runtime_error& rte)
+		{
+			std::cout << rte.what() << std::endl;
+			return -1;
+		}
+		catch (std::invalid_argument& ia)
+		{
+			std::cout << ia.what() << std::endl;
+			return -1;
+		}
+		return 0;
+	}
+
 	/* 1. Users' inputs */
 	std::string metric, metricInput;
 	do {
@@ -79,8 +264,66 @@ int main()
 	std::cout << "metric: " << metric << std::endl;
 	std::cout << "algorithm: " << algorithm << std::endl;
 	std::cout << "quantum: " << quantum << std::endl;
+	std::cout << "warm start: " << warmStart << std::endl;
+	std::cout << "threads: " << threadsNum << std::endl;
+	std::cout << "solver: " << GetSolver().GetName() << std::endl;
+	if (timeBudget > 0)
+		std::cout << "time budget: " << timeBudget << " seconds" << std::endl;
+	if (evalBudget)
+		std::cout << "evaluation budget: " << evalBudget << std::endl;
+	if (GetAsymptoticThreshold())
+		std::cout << "asymptotic from alphabet size: " << GetAsymptoticThreshold() << std::endl;
 	std::cout << std::endl;
 
+	if (validationPoints)
+	{
+		for (auto i = 0; i < alphabetSizes.size(); i++)
+		{
+			try
+			{
+				ValidateSolvers(VectorSpace(metric, alphabetSizes[i]), validationPoints, std::cout);
+			}
+			catch (std::invalid_argument& ia)
+			{
+				std::cout << ia.what() << std::endl;
+				return -1;
+			}
+			std::cout << std::endl;
+		}
+		return 0;
+	}
+
+	if (!landscapeFile.empty())
+	{
+		for (auto i = 0; i < alphabetSizes.size(); i++)
+		{
+			std::string filename = LandscapeFilename(landscapeFile, alphabetSizes[i], alphabetSizes.size() > 1);
+			std::cout << "Exporting landscape of alphabet size " << alphabetSizes[i] << " to " << filename << std::endl;
+			auto t1 = std::chrono::high_resolution_clock::now();
+			try
+			{
+				double weight = landscapeWeight >= 0 ? landscapeWeight
+					: HardestWeight(metric, alphabetSizes[i], landscapeCodeRate);
+				InformationSetDecoding isd(alphabetSizes[i], landscapeCodeRate, weight, metric, algorithm);
+				ExportLandscape(isd, gridRows, gridCols, tableSize, filename);
+			}
+			catch (std::runtime_error& rte)
+			{
+				std::cout << rte.what() << std::endl;
+				return -1;
+			}
+			catch (std::invalid_argument& ia)
+			{
+				std::cout << ia.what() << std::endl;
+				return -1;
+			}
+			auto t2 = std::chrono::high_resolution_clock::now();
+			auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
+			std::cout << "Time elapsed: ~" << duration / 1000.0 << " seconds." << std::endl << std::endl;
+		}
+		return 0;
+	}
+
 	// 2. Calculating the hardest instances
 	std::string outputFilename = "results";
 	if (quantum)
@@ -89,10 +332,22 @@ int main()
 	}
 	std::fstream outputFile(outputFilename + ".txt", std::ofstream::out |
 		std::ofstream::trunc);
-	outputFile << "alphabetSize codeRate weight optLevelNum paramL paramP ";
-	outputFile << "runtime(log 2) runtime(log alphabetSize)" << std::endl;
+	WriteResultsHeader(outputFile);
 	outputFile.close();
 
+	// The error of the large-alphabet evaluation is estimated once against an
+	// exact solver.
+	double asymptoticError = 0;
+	if (UsesAsymptotic(*std::max_element(alphabetSizes.begin(), alphabetSizes.end())))
+	{
+		asymptoticError = AsymptoticErrorEstimate(metric, 257);
+		std::cout << "Asymptotic surface areas deviate from the " << AsymptoticReference().GetName();
+		std::cout << " solver by up to ";
+		std::cout << std::scientific << std::setprecision(1) << asymptoticError << std::defaultfloat;
+		std::cout << std::endl << std::endl;
+	}
+
+	WarmStart predictor;
 	for (auto i = 0; i < alphabetSizes.size(); i++)
 	{
 		std::cout << "Prosessing alphabet size: " << alphabetSizes[i] << std::endl;
@@ -100,11 +355,17 @@ int main()
 
 		double paramL, paramP, weight, codeRate, runTime;
 		unsigned int optLevelNum;
-		std::function<double(double)> runTimeFun = [&](double cr) {return RunTime(metric, algorithm, alphabetSizes[i],
-			cr, weight, paramL, paramP, optLevelNum); };
+		SearchStage seed;
+		if (warmStart)
+			predictor.Predict(alphabetSizes[i], seed);
+		costModelEvals = 0;
+		searchProgress.Start(timeBudget, evalBudget, progressInterval, std::cout);
 		try
 		{
-			codeRate = GoldenSectionSearch(epsilon, 1.0 - epsilon, tol, runTimeFun);
+			runTime = HardestInstance(metric, algorithm, alphabetSizes[i], codeRate, weight, paramL, paramP,
+				optLevelNum, seed);
+			searchProgress.Stop();
+			predictor.Add(alphabetSizes[i], codeRate);
 		}
 		catch (std::runtime_error& rte)
 		{
@@ -118,36 +379,22 @@ int main()
 		}
 		catch (...) { std::cout << "Default exception."; }
 
-		try
-		{
-			runTime = RunTime(metric, algorithm, alphabetSizes[i], codeRate, weight, paramL, paramP, optLevelNum);
-		}
-		catch (std::runtime_error& rte)
-		{
-			std::cout << rte.what() << std::endl;
-			return -1;
-		}
-		catch (std::invalid_argument& ia)
+		outputFile.open(outputFilename + ".txt", std::ios_base::app);
+		WriteResultsRow(outputFile, alphabetSizes[i], codeRate, weight, optLevelNum, paramL, paramP, -runTime);
+		std::string notes[] = { BudgetNote(alphabetSizes[i]), AsymptoticNote(alphabetSizes[i], asymptoticError) };
+		for (auto n = 0; n < 2; n++)
 		{
-			std::cout << ia.what() << std::endl;
-			return -1;
+			if (notes[n].empty())
+				continue;
+			outputFile << notes[n] << std::endl;
+			std::cout << std::endl << notes[n].substr(2) << std::endl;
 		}
-		catch (...) { std::cout << "Default exception."; }
-
-		outputFile.open(outputFilename + ".txt", std::ios_base::app);
-		outputFile << std::fixed << std::setprecision(1) << std::setfill('0') << std::setw(3) << alphabetSizes[i] << "          ";
-		outputFile << std::fixed << std::setprecision(3) << codeRate << "    ";
-		outputFile << std::fixed << std::setprecision(3) << weight << "  ";
-		outputFile << std::fixed << std::setprecision(1) << std::setfill('0') << std::setw(3) << optLevelNum << "         ";
-		outputFile << std::fixed << std::setprecision(3) << paramL << "  ";
-		outputFile << std::fixed << std::setprecision(3) << paramP << "  ";
-		outputFile << std::fixed << std::setprecision(3) << -runTime << "          ";
-		outputFile << std::fixed << std::setprecision(3) << -runTime / log2(alphabetSizes[i]) << std::endl;
 		outputFile.close();
 
 		auto t2 = std::chrono::high_resolution_clock::now();
 		auto duration = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
-		std::cout << std::endl << "Time elapsed: ~" << duration / 1000000 << " seconds." << std::endl << std::endl << std::endl;
+		std::cout << std::endl << "Cost-model evaluations: " << costModelEvals << std::endl;
+		std::cout << "Time elapsed: ~" << duration / 1000000 << " seconds." << std::endl << std::endl << std::endl;
 	}
 
 	std::cout << "FIINISHED - The parameters of the hardest instances can be found in ";
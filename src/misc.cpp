@@ -1,5 +1,7 @@
 #include "misc.h"
+#include "parallel.h"
 #include <cmath>
+#include <algorithm>
 
 bool MetricCheck(std::string m)
 {
@@ -25,14 +27,22 @@ bool AlphabetSizeCheck(int alphabetSize)
     return false;
 }
 
-double GoldenSectionSearch(double a, double b, double tol, const std::function<double(double)>& f)
+// The probes at c and d are independent and run concurrently on the shared
+// task pool, so f must be safe to call from several threads.
+double GoldenSectionSearch(double a, double b, double tol, const std::function<double(double)>& f,
+    const BracketMonitor& monitor)
 {
     const double gr = (sqrt(5) + 1) / 2;
     double c = b - (b - a) / gr;
     double d = a + (b - a) / gr;
     while (std::abs(c - d) > tol)
     {
-        if (f(c) < f(d))
+        if (monitor && !monitor(a, b))
+            break;
+
+        double fc, fd;
+        ParallelInvoke([&]() {fc = f(c); }, [&]() {fd = f(d); });
+        if (fc < fd)
         {
             b = d;
         }
@@ -43,6 +53,40 @@ double GoldenSectionSearch(double a, double b, double tol, const std::function<d
         c = b - (b - a) / gr;
         d = a + (b - a) / gr;
     }
+    if (monitor)
+        monitor(a, b);
 
     return (b + a) / 2;
 }
+
+// Whether the minimum x found on [low, high] lies on an edge of it that is not
+// an edge of [a, b]. The search stops on a bracket at most tol / (2 / gr - 1)
+// ~ 4.24 tol wide, so a minimum on an edge leaves the returned midpoint within
+// 2.12 tol of it.
+bool OnNarrowedEdge(double x, double low, double high, double a, double b, double tol)
+{
+    const double edgeTol = 2.5 * tol;
+    return (low > a && x - low <= edgeTol) || (high < b && high - x <= edgeTol);
+}
+
+// Starts the search on the bracket [guess - radius, guess + radius] clipped to
+// [a, b] and falls back to the whole of [a, b] when the minimum lands on an
+// edge of the narrowed bracket that is not an edge of [a, b]. A non-positive
+// radius searches [a, b] directly.
+double GoldenSectionSearch(double a, double b, double tol, const std::function<double(double)>& f,
+    double guess, double radius, const BracketMonitor& monitor)
+{
+    if (radius <= 0)
+        return GoldenSectionSearch(a, b, tol, f, monitor);
+
+    double low = std::max(a, guess - radius);
+    double high = std::min(b, guess + radius);
+    if (high - low <= 5 * tol)
+        return GoldenSectionSearch(a, b, tol, f, monitor);
+
+    double x = GoldenSectionSearch(low, high, tol, f, monitor);
+    if (OnNarrowedEdge(x, low, high, a, b, tol))
+        return GoldenSectionSearch(a, b, tol, f, monitor);
+
+    return x;
+}
@@ -8,6 +8,15 @@ bool ParamCheck(double);
 bool AlgCheck(std::string);
 bool AlphabetSizeCheck(int);
 
-double GoldenSectionSearch(double, double, double, const std::function<double(double)>&);
+// Sees the bracket of every iteration of a golden section search, and the final
+// one, and stops the search, which then returns the midpoint of that bracket,
+// by returning false.
+typedef std::function<bool(double, double)> BracketMonitor;
+
+double GoldenSectionSearch(double, double, double, const std::function<double(double)>&,
+	const BracketMonitor& = BracketMonitor());
+bool OnNarrowedEdge(double, double, double, double, double, double);
+double GoldenSectionSearch(double, double, double, const std::function<double(double)>&, double, double,
+	const BracketMonitor& = BracketMonitor());
 
 #endif
@@ -0,0 +1,67 @@
+#include <vector>
+#include <cmath>
+#include "fusion.h"
+#include "monty.h"
+#include "space.h"
+#include "solver.h"
+
+using namespace mosek::fusion;
+using namespace monty;
+
+void LinConstrs(double distance, const VectorSpace& space, const Model::t& M, const Variable::t& x)
+{
+	M->constraint("lc1", Expr::sum(x), Domain::equalsTo(1.0));
+
+	std::vector<double> coeffs(space.GetAlphabetSize());
+	for (auto i = 0; i < space.GetAlphabetSize(); ++i)
+	{
+		coeffs[i] = (double) Weight(space, i);
+	}
+
+	auto coeffs_ptr = new_array_ptr<double>(coeffs);
+	M->constraint("lc2", Expr::dot(coeffs_ptr, x), Domain::equalsTo(distance * MaxWeight(space)));
+}
+
+void ExpConicConstrs(const VectorSpace& space, const Model::t& M, const Variable::t& t, const Variable::t& x)
+{
+	for (auto i = 0; i < space.GetAlphabetSize(); i++)
+	{
+		M->constraint(Expr::hstack(1, x->index(i), t->index(i)), Domain::inPExpCone());
+	}
+}
+
+// Exponential-cone formulation solved by MOSEK Fusion: t_i <= -x_i log(x_i).
+class MosekSurfaceSolver : public SurfaceSolver
+{
+public:
+	std::string GetName() const { return "mosek"; }
+	double SphereSurfArea(const VectorSpace& space, double distance) const
+	{
+		Model::t M = new Model("space");
+		auto _M = finally([&]() {M->dispose(); });
+
+		Variable::t x = M->variable("x", space.GetAlphabetSize(), Domain::greaterThan(0.0));
+		Variable::t t = M->variable("t", space.GetAlphabetSize());
+
+		LinConstrs(distance, space, M, x);
+		ExpConicConstrs(space, M, t, x);
+
+		M->objective("obj", ObjectiveSense::Maximize, Expr::sum(t));
+		M->solve();
+
+		if (M->getProblemStatus() == ProblemStatus::PrimalAndDualFeasible)
+		{
+			if (M->getPrimalSolutionStatus() == SolutionStatus::Optimal)
+			{
+				return M->primalObjValue() / log(space.GetAlphabetSize());
+			}
+		}
+		return -1;
+	}
+};
+
+const SurfaceSolver& MosekSolver()
+{
+	static MosekSurfaceSolver solver;
+	return solver;
+}
@@ -0,0 +1,141 @@
+#include <atomic>
+#include <algorithm>
+#include <exception>
+#include "parallel.h"
+
+unsigned int threadsNum = std::max(1u, std::thread::hardware_concurrency());
+
+struct TaskPool::Task
+{
+	std::function<void()> fun;
+	std::atomic<bool> claimed;
+	bool done;
+	std::exception_ptr error;
+	std::mutex mutex;
+	std::condition_variable cv;
+	Task(const std::function<void()>& f) : fun(f), claimed(false), done(false) {}
+	void Run()
+	{
+		try
+		{
+			fun();
+		}
+		catch (...)
+		{
+			error = std::current_exception();
+		}
+		std::lock_guard<std::mutex> lock(mutex);
+		done = true;
+		cv.notify_all();
+	}
+};
+
+TaskPool::TaskPool(unsigned int workersNum) : stop(false)
+{
+	for (auto i = 0; i < workersNum; i++)
+	{
+		workers.push_back(std::thread(&TaskPool::Work, this));
+	}
+}
+
+TaskPool::~TaskPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop = true;
+	}
+	cv.notify_all();
+	for (auto i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+}
+
+void TaskPool::Work()
+{
+	while (true)
+	{
+		std::shared_ptr<Task> task;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			cv.wait(lock, [&]() {return stop || !tasks.empty(); });
+			if (stop && tasks.empty())
+				return;
+			task = tasks.front();
+			tasks.pop_front();
+		}
+		if (!task->claimed.exchange(true))
+			task->Run();
+	}
+}
+
+void TaskPool::Invoke(const std::function<void()>& first, const std::function<void()>& second)
+{
+	if (workers.empty())
+	{
+		first();
+		second();
+		return;
+	}
+
+	std::shared_ptr<Task> task = std::make_shared<Task>(second);
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		tasks.push_back(task);
+	}
+	cv.notify_one();
+
+	std::exception_ptr error;
+	try
+	{
+		first();
+	}
+	catch (...)
+	{
+		error = std::current_exception();
+	}
+
+	if (!task->claimed.exchange(true))
+	{
+		task->Run();
+	}
+	else
+	{
+		std::unique_lock<std::mutex> lock(task->mutex);
+		task->cv.wait(lock, [&]() {return task->done; });
+	}
+
+	if (error)
+		std::rethrow_exception(error);
+	if (task->error)
+		std::rethrow_exception(task->error);
+}
+
+// Created on first use with threadsNum - 1 workers, the calling thread being
+// the remaining one.
+TaskPool& SharedPool()
+{
+	static TaskPool pool(threadsNum - 1);
+	return pool;
+}
+
+void ParallelInvoke(const std::function<void()>& first, const std::function<void()>& second)
+{
+	SharedPool().Invoke(first, second);
+}
+
+// Runs f(i) for every i in [begin, end) by splitting the range into halves
+// that are invoked as fork-join pairs.
+void ParallelFor(unsigned int begin, unsigned int end, const std::function<void(unsigned int)>& f)
+{
+	if (begin >= end)
+		return;
+	if (end - begin == 1)
+	{
+		f(begin);
+		return;
+	}
+
+	unsigned int middle = begin + (end - begin) / 2;
+	ParallelInvoke([&]() {ParallelFor(begin, middle, f); }, [&]() {ParallelFor(middle, end, f); });
+}
@@ -0,0 +1,41 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+extern unsigned int threadsNum;
+
+// Fixed set of worker threads running fork-join pairs of tasks. The caller of
+// Invoke runs the first task itself and also the second one unless a worker
+// has already picked it up, so nested calls from inside tasks cannot deadlock
+// the pool however deep the nesting of the searches is.
+class TaskPool
+{
+private:
+	struct Task;
+	std::vector<std::thread> workers;
+	std::deque<std::shared_ptr<Task> > tasks;
+	std::mutex mutex;
+	std::condition_variable cv;
+	bool stop;
+	void Work();
+public:
+	explicit TaskPool(unsigned int);
+	~TaskPool();
+	TaskPool(const TaskPool&) = delete;
+	TaskPool& operator=(const TaskPool&) = delete;
+	unsigned int GetWorkersNum() const { return workers.size(); }
+	void Invoke(const std::function<void()>&, const std::function<void()>&);
+};
+
+TaskPool& SharedPool();
+void ParallelInvoke(const std::function<void()>&, const std::function<void()>&);
+void ParallelFor(unsigned int, unsigned int, const std::function<void(unsigned int)>&);
+
+#endif
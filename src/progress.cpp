@@ -0,0 +1,186 @@
+#include <cmath>
+#include <iomanip>
+#include <algorithm>
+#include "progress.h"
+#include "isd.h"
+
+SearchProgress searchProgress;
+
+thread_local double SearchProgress::innerWidths[LevelsNum];
+
+SearchProgress::SearchProgress() : timeLimited(false), evalsStart(0), evalsLimit(0), expired(false),
+	stage(0), stagesNum(0), codeRateLow(0), codeRateHigh(0), found(false), bestStage(0), bestLevelNum(0), bestCodeRate(0), bestWeight(0),
+	bestL(0), bestP(0), bestRunTime(0), bestLWidth(0), bestPWidth(0), stopReporter(false)
+{
+	lastRunTimes[0] = lastRunTimes[1] = 0;
+}
+
+// A non-positive number of seconds, evaluations or reporting interval means
+// no time budget, no evaluation budget or no reports.
+void SearchProgress::Start(double seconds, unsigned long long evals, double interval, std::ostream& out)
+{
+	Stop();
+
+	start = std::chrono::steady_clock::now();
+	timeLimited = seconds > 0;
+	deadline = start + std::chrono::microseconds((long long)(std::max(0.0, seconds) * 1e6));
+	evalsStart = costModelEvals;
+	evalsLimit = evals;
+	expired = false;
+	stage = stagesNum = 0;
+	codeRateLow = codeRateHigh = 0;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		found = false;
+		lastRunTimes[0] = lastRunTimes[1] = 0;
+		stopReporter = false;
+	}
+
+	if (interval > 0)
+	{
+		reporter = std::thread([this, interval, &out]()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			while (!cv.wait_for(lock, std::chrono::milliseconds((long long)(interval * 1000)),
+				[this]() {return stopReporter; }))
+			{
+				double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				Report(out, elapsed);
+			}
+		});
+	}
+}
+
+void SearchProgress::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopReporter = true;
+	}
+	cv.notify_all();
+	if (reporter.joinable())
+		reporter.join();
+}
+
+bool SearchProgress::Expired()
+{
+	if (expired)
+		return true;
+	if ((timeLimited && std::chrono::steady_clock::now() >= deadline)
+		|| (evalsLimit && costModelEvals - evalsStart >= evalsLimit))
+	{
+		expired = true;
+	}
+	return expired;
+}
+
+void SearchProgress::SetStage(unsigned int s, unsigned int sNum)
+{
+	stage = s;
+	stagesNum = sNum;
+}
+
+// Records the bracket of the given search level as long as the budget lasts,
+// so that searches cut short by the budget leave the last complete brackets.
+// The inner searches of concurrent outer probes run on different threads, so
+// the widths of the (L, P) brackets are kept per thread: the last inner
+// searches of a probe run on the thread that reports it to AddProbe, which
+// clears them for the next probe of that thread.
+BracketMonitor SearchProgress::Monitor(Level level)
+{
+	return [this, level](double a, double b)
+	{
+		if (Expired())
+			return false;
+		if (level == CodeRateLevel)
+		{
+			codeRateLow = a;
+			codeRateHigh = b;
+		}
+		else
+			innerWidths[level] = b - a;
+		return true;
+	};
+}
+
+// Forgets the best probe and the brackets, for a search that starts over from
+// its first stage; the budget and the evaluations spent so far are kept.
+void SearchProgress::ResetBest()
+{
+	codeRateLow = codeRateHigh = 0;
+	std::lock_guard<std::mutex> lock(mutex);
+	found = false;
+	bestLWidth = bestPWidth = 0;
+	lastRunTimes[0] = lastRunTimes[1] = 0;
+}
+
+// Keeps the probe with the highest running time among those of the most
+// precise stage, since coarse stages overestimate the inner minima.
+void SearchProgress::AddProbe(double codeRate, double weight, double paramL, double paramP,
+	unsigned int optLevelNum, double runTime)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!found || stage > bestStage || (stage == bestStage && runTime > bestRunTime))
+	{
+		found = true;
+		bestStage = stage;
+		bestCodeRate = codeRate;
+		bestWeight = weight;
+		bestL = paramL;
+		bestP = paramP;
+		bestLevelNum = optLevelNum;
+		bestRunTime = runTime;
+		bestLWidth = innerWidths[ParamLLevel];
+		bestPWidth = innerWidths[ParamPLevel];
+	}
+	innerWidths[ParamLLevel] = innerWidths[ParamPLevel] = 0;
+	lastRunTimes[0] = lastRunTimes[1];
+	lastRunTimes[1] = runTime;
+}
+
+bool SearchProgress::GetBest(double& codeRate, double& weight, double& paramL, double& paramP,
+	unsigned int& optLevelNum, double& runTime) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!found)
+		return false;
+
+	codeRate = bestCodeRate;
+	weight = bestWeight;
+	paramL = bestL;
+	paramP = bestP;
+	optLevelNum = bestLevelNum;
+	runTime = bestRunTime;
+	return true;
+}
+
+// The optimal code rate lies in the current outer bracket, and L and P within
+// the inner brackets of the best probe; the running time is uncertain by about the gap
+// between the last two outer probes.
+void SearchProgress::ErrorEstimate(double& codeRateErr, double& paramLErr, double& paramPErr, double& runTimeErr) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	codeRateErr = std::max(std::abs(bestCodeRate - codeRateLow), std::abs(codeRateHigh - bestCodeRate));
+	paramLErr = bestLWidth;
+	paramPErr = bestPWidth;
+	runTimeErr = std::abs(lastRunTimes[1] - lastRunTimes[0]);
+}
+
+// Called by the reporter thread with the mutex held.
+void SearchProgress::Report(std::ostream& out, double elapsed)
+{
+	std::ios_base::fmtflags flags = out.flags();
+	out << std::fixed << std::setprecision(1) << "[" << elapsed << " s] stage ";
+	out << std::min(stage + 1, stagesNum.load()) << "/" << stagesNum;
+	out << ", " << costModelEvals - evalsStart << " evaluations";
+	if (found)
+	{
+		out << std::setprecision(4) << ", best: codeRate " << bestCodeRate << " weight " << bestWeight;
+		out << " L " << bestL << " P " << bestP << " level " << bestLevelNum << " runtime " << bestRunTime;
+	}
+	out << std::scientific << std::setprecision(1) << ", brackets: codeRate " << codeRateHigh - codeRateLow;
+	if (found)
+		out << " L " << bestLWidth << " P " << bestPWidth;
+	out << std::endl;
+	out.flags(flags);
+}
@@ -0,0 +1,59 @@
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <ostream>
+#include "misc.h"
+
+// Budget, best-so-far point and bracket widths of the hardest-instance search
+// of one alphabet size. The searches stop once the wall-clock or the
+// cost-model evaluation budget is spent, and a reporter thread prints the
+// state of the search periodically meanwhile. The outer code-rate bracket is
+// shared, while the (L, P) brackets belong to the probe whose inner searches
+// narrowed them and are kept together with the best probe.
+class SearchProgress
+{
+public:
+	enum Level { CodeRateLevel, ParamLLevel, ParamPLevel, LevelsNum };
+private:
+	std::chrono::steady_clock::time_point start, deadline;
+	bool timeLimited;
+	unsigned long long evalsStart, evalsLimit;
+	std::atomic<bool> expired;
+	std::atomic<unsigned int> stage, stagesNum;
+	std::atomic<double> codeRateLow, codeRateHigh;
+	static thread_local double innerWidths[LevelsNum];
+
+	mutable std::mutex mutex;
+	bool found;
+	unsigned int bestStage, bestLevelNum;
+	double bestCodeRate, bestWeight, bestL, bestP, bestRunTime;
+	double bestLWidth, bestPWidth;
+	double lastRunTimes[2];
+
+	std::thread reporter;
+	std::condition_variable cv;
+	bool stopReporter;
+	void Report(std::ostream&, double);
+public:
+	SearchProgress();
+	~SearchProgress() { Stop(); }
+	void Start(double, unsigned long long, double, std::ostream&);
+	void Stop();
+	bool Expired();
+	void SetStage(unsigned int, unsigned int);
+	bool Complete() const { return stagesNum && stage == stagesNum; }
+	BracketMonitor Monitor(Level);
+	void ResetBest();
+	void AddProbe(double, double, double, double, unsigned int, double);
+	bool GetBest(double&, double&, double&, double&, unsigned int&, double&) const;
+	void ErrorEstimate(double&, double&, double&, double&) const;
+};
+
+extern SearchProgress searchProgress;
+
+#endif
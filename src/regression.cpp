@@ -0,0 +1,165 @@
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include "regression.h"
+#include "isd.h"
+#include "progress.h"
+#include "solver.h"
+
+// Runs the hardest-instance search of a case; returns its wall-clock time in
+// seconds, or -1 if it has not finished within budget seconds (0 for no budget).
+static double RunCase(RegressionCase& c, double budget, std::ostream& out)
+{
+	quantum = !c.regime.compare("quantum");
+	costModelEvals = 0;
+	auto t1 = std::chrono::high_resolution_clock::now();
+	searchProgress.Start(budget, 0, 0, out);
+	try
+	{
+		c.runTime = -HardestInstance(c.metric, c.algorithm, c.alphabetSize, c.codeRate, c.weight, c.paramL, c.paramP,
+			c.optLevelNum);
+	}
+	catch (std::runtime_error&)
+	{
+		searchProgress.Stop();
+		return -1;
+	}
+	searchProgress.Stop();
+	auto t2 = std::chrono::high_resolution_clock::now();
+	if (!searchProgress.Complete())
+		return -1;
+	return std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() / 1000000.0;
+}
+
+// Reads the cases of a reference file and the name of the solver it was
+// recorded with from its "# solver" header (empty if the file has none).
+std::vector<RegressionCase> ReadRegressionCases(const std::string& filename, std::string& solver)
+{
+	std::ifstream inputFile(filename);
+	if (!inputFile)
+		throw std::invalid_argument("Regression file " + filename + " cannot be opened.");
+
+	std::vector<RegressionCase> cases;
+	std::string line;
+	solver.clear();
+	while (std::getline(inputFile, line))
+	{
+		if (!line.compare(0, 9, "# solver "))
+			solver = line.substr(9);
+		if (line.empty() || line[0] == '#')
+			continue;
+		std::istringstream ss(line);
+		RegressionCase c;
+		ss >> c.metric >> c.algorithm >> c.regime >> c.alphabetSize >> c.codeRate >> c.weight >> c.optLevelNum;
+		ss >> c.paramL >> c.paramP >> c.runTime >> c.budget;
+		if (!ss || !MetricCheck(c.metric) || !AlgCheck(c.algorithm)
+			|| (c.regime.compare("classical") && c.regime.compare("quantum")) || !AlphabetSizeCheck(c.alphabetSize))
+			throw std::invalid_argument("Invalid regression case: " + line);
+		cases.push_back(c);
+	}
+	return cases;
+}
+
+// Runs every metric, algorithm and regime for the given alphabet sizes and
+// writes the results as the reference, each with a budget of three times its
+// running time (at least one second). Nothing is written if any case fails,
+// so that a failed search never becomes a reference.
+void RecordRegression(const std::string& filename, const std::vector<unsigned int>& alphabetSizes, std::ostream& out)
+{
+	const char* metrics[] = { "hamming", "lee" };
+	const char* algorithms[] = { "prange", "dumer", "wagner" };
+	const char* regimes[] = { "classical", "quantum" };
+
+	std::stringstream rows;
+	rows << "# solver " << GetSolver().GetName() << std::endl;
+	rows << "# metric algorithm regime alphabetSize codeRate weight optLevelNum paramL paramP ";
+	rows << "runtime(log 2) budget(s)" << std::endl;
+	for (auto m = 0; m < 2; m++)
+		for (auto a = 0; a < 3; a++)
+			for (auto r = 0; r < 2; r++)
+				for (auto i = 0; i < alphabetSizes.size(); i++)
+				{
+					RegressionCase c;
+					c.metric = metrics[m];
+					c.algorithm = algorithms[a];
+					c.regime = regimes[r];
+					c.alphabetSize = alphabetSizes[i];
+					double seconds = RunCase(c, 0, out);
+					if (seconds < 0)
+					{
+						std::stringstream name;
+						name << c.metric << " " << c.algorithm << " " << c.regime << " " << c.alphabetSize;
+						throw std::runtime_error("The search of " + name.str() + " failed; nothing was recorded.");
+					}
+					c.budget = std::max(1.0, 3 * seconds);
+
+					rows << c.metric << " " << c.algorithm << " " << c.regime << " " << c.alphabetSize;
+					rows << std::fixed << std::setprecision(6) << " " << c.codeRate << " " << c.weight;
+					rows << " " << c.optLevelNum << " " << c.paramL << " " << c.paramP << " " << c.runTime;
+					rows << std::setprecision(1) << " " << c.budget << std::endl;
+					out << "recorded " << c.metric << " " << c.algorithm << " " << c.regime << " " << c.alphabetSize;
+					out << std::fixed << std::setprecision(2) << " (" << seconds << " s)" << std::endl;
+				}
+
+	std::ofstream outputFile(filename, std::ofstream::trunc);
+	if (!outputFile)
+		throw std::invalid_argument("Regression file " + filename + " cannot be created.");
+	outputFile << rows.str();
+}
+
+// Reruns every reference case and reports the largest drift of its columns and
+// its running time; returns the number of cases that drift beyond tolerance or
+// run out of their budget. The reference must have been recorded with the
+// selected solver, since the solvers agree only up to their own precision.
+unsigned int CheckRegression(const std::string& filename, double tolerance, std::ostream& out)
+{
+	std::string solver;
+	std::vector<RegressionCase> cases = ReadRegressionCases(filename, solver);
+	if (solver.empty())
+	{
+		out << "Regression file " << filename << " does not name its solver; checking with ";
+		out << GetSolver().GetName() << "." << std::endl;
+	}
+	else if (solver.compare(GetSolver().GetName()))
+		throw std::invalid_argument("Regression file " + filename + " was recorded with the " + solver
+			+ " solver, but the " + GetSolver().GetName() + " solver is selected (see --solver).");
+
+	unsigned int failures = 0;
+	out << "case                                    maxDrift   time(s)  budget(s)  status" << std::endl;
+	for (auto i = 0; i < cases.size(); i++)
+	{
+		const RegressionCase& ref = cases[i];
+		RegressionCase c = ref;
+		double seconds = RunCase(c, ref.budget, out);
+
+		std::stringstream name;
+		name << ref.metric << " " << ref.algorithm << " " << ref.regime << " " << ref.alphabetSize;
+		out << std::left << std::setw(40) << name.str() << std::right;
+
+		std::string status = "ok";
+		if (seconds < 0)
+		{
+			status = "FAILED (over budget)";
+			out << "         -         -";
+		}
+		else
+		{
+			double drift = std::max({ std::abs(c.codeRate - ref.codeRate), std::abs(c.weight - ref.weight),
+				std::abs(c.paramL - ref.paramL), std::abs(c.paramP - ref.paramP), std::abs(c.runTime - ref.runTime) });
+			if (c.optLevelNum != ref.optLevelNum)
+				status = "FAILED (optLevelNum)";
+			else if (drift > tolerance)
+				status = "FAILED (drift)";
+			out << std::scientific << std::setprecision(2) << drift;
+			out << std::fixed << std::setprecision(2) << std::setw(10) << seconds;
+		}
+		out << std::fixed << std::setprecision(2) << std::setw(11) << ref.budget << "  " << status << std::endl;
+		failures += status.compare("ok") != 0;
+	}
+	out << std::defaultfloat << failures << " of " << cases.size() << " cases failed." << std::endl;
+	return failures;
+}
@@ -0,0 +1,23 @@
+#ifndef REGRESSION_H
+#define REGRESSION_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+// One hardest-instance search of the regression matrix together with its
+// reference columns of the results file and its wall-clock budget in seconds.
+struct RegressionCase
+{
+	std::string metric, algorithm, regime;
+	unsigned int alphabetSize;
+	double codeRate, weight, paramL, paramP, runTime;
+	unsigned int optLevelNum;
+	double budget;
+};
+
+std::vector<RegressionCase> ReadRegressionCases(const std::string&, std::string&);
+void RecordRegression(const std::string&, const std::vector<unsigned int>&, std::ostream&);
+unsigned int CheckRegression(const std::string&, double, std::ostream&);
+
+#endif
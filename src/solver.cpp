@@ -0,0 +1,171 @@
+#include <cmath>
+#include <chrono>
+#include <iomanip>
+#include <stdexcept>
+#include <algorithm>
+#include "space.h"
+#include "solver.h"
+
+// Finds the multiplier lambda at which the mean weight of the Gibbs
+// distribution, decreasing in lambda, hits the target in (0, maxWeight): the
+// bracket is doubled until it holds the root, then Newton steps are taken,
+// falling back to bisection whenever they leave the bracket. Returns lambda
+// and leaves the moments at lambda in m; the maximal entropy is then
+// m.logPartition + lambda * m.mean.
+double SolveMultiplier(const std::function<Moments(double)>& gibbs, double target, unsigned int maxWeight,
+	Moments& m)
+{
+	double low = -1, high = 1;
+	while (gibbs(low).mean < target)
+		low *= 2;
+	while (gibbs(high).mean > target)
+		high *= 2;
+
+	double lambda = 0;
+	m = gibbs(lambda);
+	for (auto i = 0; i < 200 && std::abs(m.mean - target) > 1e-14 * maxWeight && high - low > 1e-15; i++)
+	{
+		if (m.mean > target)
+			low = lambda;
+		else
+			high = lambda;
+
+		double next = m.variance > 0 ? lambda + (m.mean - target) / m.variance : low;
+		lambda = next > low && next < high ? next : (low + high) / 2;
+		m = gibbs(lambda);
+	}
+	return lambda;
+}
+
+// The entropy maximizer has the Gibbs form x_i ~ exp(-lambda * Weight(i)), so
+// the problem reduces to finding the multiplier lambda at which the average
+// weight hits the target, done by SolveMultiplier on the weight classes of the
+// alphabet.
+class NativeSurfaceSolver : public SurfaceSolver
+{
+private:
+	static Moments Gibbs(const std::vector<double>& counts, double lambda)
+	{
+		double shift = lambda >= 0 ? 0.0 : lambda * (counts.size() - 1);
+		double z = 0, s1 = 0, s2 = 0;
+		for (auto k = 0; k < counts.size(); k++)
+		{
+			if (counts[k] == 0)
+				continue;
+			double e = counts[k] * exp(shift - lambda * k);
+			z += e;
+			s1 += e * k;
+			s2 += e * k * k;
+		}
+		Moments m;
+		m.logPartition = log(z) - shift;
+		m.mean = s1 / z;
+		m.variance = std::max(0.0, s2 / z - m.mean * m.mean);
+		return m;
+	}
+public:
+	std::string GetName() const { return "native"; }
+	double SphereSurfArea(const VectorSpace& space, double distance) const
+	{
+		if (!ParamCheck(distance))
+			return -1;
+
+		unsigned int maxWeight = MaxWeight(space);
+		std::vector<double> counts(maxWeight + 1, 0.0);
+		for (auto i = 0; i < space.GetAlphabetSize(); i++)
+		{
+			counts[Weight(space, i)]++;
+		}
+
+		double target = distance * maxWeight;
+		double logSize = log(space.GetAlphabetSize());
+		if (target <= 0)
+			return log(counts[0]) / logSize;
+		if (target >= maxWeight)
+			return log(counts[maxWeight]) / logSize;
+
+		Moments m;
+		double lambda = SolveMultiplier([&](double l) {return Gibbs(counts, l); }, target, maxWeight, m);
+		return (m.logPartition + lambda * m.mean) / logSize;
+	}
+};
+
+std::vector<const SurfaceSolver*> Solvers()
+{
+	static NativeSurfaceSolver native;
+	std::vector<const SurfaceSolver*> solvers;
+#ifndef ISD_NO_MOSEK
+	solvers.push_back(&MosekSolver());
+#endif
+	solvers.push_back(&native);
+	solvers.push_back(&AsymptoticSolver());
+	return solvers;
+}
+
+static const SurfaceSolver* currentSolver = nullptr;
+
+// The first backend of Solvers() unless another one is selected.
+const SurfaceSolver& GetSolver()
+{
+	if (!currentSolver)
+		currentSolver = Solvers().front();
+	return *currentSolver;
+}
+
+void SetSolver(const std::string& name)
+{
+	std::vector<const SurfaceSolver*> solvers = Solvers();
+	for (auto i = 0; i < solvers.size(); i++)
+	{
+		if (!solvers[i]->GetName().compare(name))
+		{
+			currentSolver = solvers[i];
+			return;
+		}
+	}
+	throw std::invalid_argument("Solver " + name + " is not offered in this build.");
+}
+
+// Solves the surface areas of pointsNum distances evenly spread over [0, 1]
+// with every backend and reports their per-call latency and their differences
+// from the first backend.
+void ValidateSolvers(const VectorSpace& space, unsigned int pointsNum, std::ostream& out)
+{
+	std::vector<const SurfaceSolver*> solvers = Solvers();
+	std::vector<std::vector<double> > areas(solvers.size(), std::vector<double>(pointsNum));
+
+	out << "metric: " << space.GetMetric() << ", alphabet size: " << space.GetAlphabetSize();
+	out << ", distances: " << pointsNum << std::endl;
+	out << "solver      latency(ms)  maxAbsDiff   meanAbsDiff  failures" << std::endl;
+	for (auto s = 0; s < solvers.size(); s++)
+	{
+		auto t1 = std::chrono::high_resolution_clock::now();
+		for (auto i = 0; i < pointsNum; i++)
+		{
+			areas[s][i] = solvers[s]->SphereSurfArea(space, pointsNum > 1 ? double(i) / (pointsNum - 1) : 0.5);
+		}
+		auto t2 = std::chrono::high_resolution_clock::now();
+		double latency = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() / 1000.0 / pointsNum;
+
+		double maxDiff = 0, sumDiff = 0;
+		unsigned int failures = 0, compared = 0;
+		for (auto i = 0; i < pointsNum; i++)
+		{
+			if (areas[s][i] == -1 || areas[0][i] == -1)
+			{
+				failures += areas[s][i] == -1;
+				continue;
+			}
+			double diff = std::abs(areas[s][i] - areas[0][i]);
+			maxDiff = std::max(maxDiff, diff);
+			sumDiff += diff;
+			compared++;
+		}
+
+		out << std::left << std::setw(12) << solvers[s]->GetName() << std::right;
+		out << std::fixed << std::setprecision(4) << std::setw(11) << latency << "  ";
+		out << std::scientific << std::setprecision(3) << maxDiff << "    " << (compared ? sumDiff / compared : 0.0);
+		out << "    " << failures << std::endl;
+	}
+	out << std::defaultfloat;
+}
@@ -0,0 +1,48 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <functional>
+
+class VectorSpace;
+
+// Backend solving the entropy subproblem behind VectorSpace::SphereSurfArea:
+// the maximal entropy of a distribution over the alphabet whose average weight
+// is the given fraction of the maximal weight, normalized by log(alphabetSize).
+// Returns -1 when no solution is found.
+class SurfaceSolver
+{
+public:
+	virtual ~SurfaceSolver() {}
+	virtual std::string GetName() const = 0;
+	virtual double SphereSurfArea(const VectorSpace&, double) const = 0;
+};
+
+// Log-partition function, mean and variance of the weights under the Gibbs
+// distribution proportional to exp(-lambda * weight).
+struct Moments
+{
+	double logPartition, mean, variance;
+};
+
+double SolveMultiplier(const std::function<Moments(double)>&, double, unsigned int, Moments&);
+
+std::vector<const SurfaceSolver*> Solvers();
+const SurfaceSolver& GetSolver();
+void SetSolver(const std::string&);
+void ValidateSolvers(const VectorSpace&, unsigned int, std::ostream&);
+
+const SurfaceSolver& AsymptoticSolver();
+void SetAsymptoticThreshold(unsigned int);
+unsigned int GetAsymptoticThreshold();
+bool UsesAsymptotic(unsigned int);
+const SurfaceSolver& AsymptoticReference();
+double AsymptoticErrorEstimate(const std::string&, unsigned int);
+
+#ifndef ISD_NO_MOSEK
+const SurfaceSolver& MosekSolver();
+#endif
+
+#endif
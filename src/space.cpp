@@ -1,51 +1,12 @@
-#include <vector>
 #include <algorithm>
 #include "space.h"
-
-void LinConstrs(double distance, const VectorSpace& space, const Model::t& M, const Variable::t& x)
-{
-	M->constraint("lc1", Expr::sum(x), Domain::equalsTo(1.0));
-
-	std::vector<double> coeffs(space.alphabetSize);
-	for (auto i = 0; i < space.alphabetSize; ++i)
-	{
-		coeffs[i] = (double) Weight(space, i);
-	}
-
-	auto coeffs_ptr = new_array_ptr<double>(coeffs);
-	M->constraint("lc2", Expr::dot(coeffs_ptr, x), Domain::equalsTo(distance * MaxWeight(space)));
-}
-
-void ExpConicConstrs(const VectorSpace& space, const Model::t& M, const Variable::t& t, const Variable::t& x)
-{
-	for (auto i = 0; i < space.alphabetSize; i++)
-	{
-		M->constraint(Expr::hstack(1, x->index(i), t->index(i)), Domain::inPExpCone());
-	}
-}
+#include "solver.h"
 
 double VectorSpace::SphereSurfArea(double distance) const
 {
-	Model::t M = new Model("space");
-	auto _M = finally([&]() {M->dispose(); });
-
-	Variable::t x = M->variable("x", alphabetSize, Domain::greaterThan(0.0));
-	Variable::t t = M->variable("t", alphabetSize);
-
-	LinConstrs(distance, *this, M, x);	
-	ExpConicConstrs(*this, M, t, x);
-
-	M->objective("obj", ObjectiveSense::Maximize, Expr::sum(t));
-	M->solve();
-
-	if (M->getProblemStatus() == ProblemStatus::PrimalAndDualFeasible)
-	{
-		if (M->getPrimalSolutionStatus() == SolutionStatus::Optimal)
-		{
-			return M->primalObjValue() / log(alphabetSize);
-		}
-	}
-	return -1;
+	if (UsesAsymptotic(alphabetSize))
+		return AsymptoticSolver().SphereSurfArea(*this, distance);
+	return GetSolver().SphereSurfArea(*this, distance);
 }
 
 unsigned int Weight(const VectorSpace& space, unsigned int element)
@@ -68,23 +29,22 @@ unsigned int Weight(const VectorSpace& space, unsigned int element)
 	return weight;
 }
 
+// Closed forms of the maximal and the total weight of the alphabet, so that
+// neither of them takes time linear in the alphabet size.
 unsigned int MaxWeight(const VectorSpace& space)
 {
-	std::vector<unsigned int> weights(space.alphabetSize);
-	for (auto i = 0; i < space.alphabetSize; ++i)
-	{
-		weights[i] = Weight(space, i);
-	}
-
-	return *std::max_element(weights.begin(), weights.end());
+	if (!space.metric.compare("lee"))
+		return space.alphabetSize / 2;
+	return 1;
 }
 
 double AvgVectorWeight(const VectorSpace& space, double length)
 {
-	double avgWeight = 0;
-	for (auto i = 0; i < space.alphabetSize; ++i)
+	double avgWeight = space.alphabetSize - 1.0;
+	if (!space.metric.compare("lee"))
 	{
-		avgWeight += (double)Weight(space, i);
+		double maxWeight = space.alphabetSize / 2;
+		avgWeight = space.alphabetSize % 2 ? maxWeight * (maxWeight + 1) : maxWeight * maxWeight;
 	}
 
 	return avgWeight / space.alphabetSize * length;
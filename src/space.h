@@ -1,13 +1,10 @@
 #ifndef SPACE_H
 #define SPACE_H
 
-#include "fusion.h"
-#include "monty.h"
+#include <string>
+#include <stdexcept>
 #include "misc.h"
 
-using namespace mosek::fusion;
-using namespace monty;
-
 class VectorSpace
 {
 protected:
@@ -53,8 +50,6 @@ public:
 		else
 			throw std::invalid_argument("Alphabet size needs to be greater or equal to 2.");
 	}
-	friend void LinConstrs(double, const VectorSpace&, const Model::t&, const Variable::t&);
-	friend void ExpConicConstrs(const VectorSpace&, const Model::t&, const Variable::t&, const Variable::t&);
 	double SphereSurfArea(double) const;
 	friend double AvgVectorWeight(const VectorSpace&, double);
 	friend unsigned int Weight(const VectorSpace&, unsigned int);
@@ -0,0 +1,361 @@
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <stdexcept>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "sweep.h"
+#include "isd.h"
+#include "progress.h"
+#include "solver.h"
+
+void WriteResultsHeader(std::ostream& outputFile)
+{
+	outputFile << "alphabetSize codeRate weight optLevelNum paramL paramP ";
+	outputFile << "runtime(log 2) runtime(log alphabetSize)" << std::endl;
+}
+
+void WriteResultsRow(std::ostream& outputFile, unsigned int alphabetSize, double codeRate, double weight,
+	unsigned int optLevelNum, double paramL, double paramP, double runTime)
+{
+	outputFile << std::fixed << std::setprecision(1) << std::setfill('0') << std::setw(3) << alphabetSize << "          ";
+	outputFile << std::fixed << std::setprecision(3) << codeRate << "    ";
+	outputFile << std::fixed << std::setprecision(3) << weight << "  ";
+	outputFile << std::fixed << std::setprecision(1) << std::setfill('0') << std::setw(3) << optLevelNum << "         ";
+	outputFile << std::fixed << std::setprecision(3) << paramL << "  ";
+	outputFile << std::fixed << std::setprecision(3) << paramP << "  ";
+	outputFile << std::fixed << std::setprecision(3) << runTime << "          ";
+	outputFile << std::fixed << std::setprecision(3) << runTime / log2(alphabetSize) << std::endl;
+}
+
+// Comment line following the row of a search stopped by its budget, or an
+// empty string if the search has completed.
+std::string BudgetNote(unsigned int alphabetSize)
+{
+	if (searchProgress.Complete())
+		return "";
+
+	double codeRateErr, paramLErr, paramPErr, runTimeErr;
+	searchProgress.ErrorEstimate(codeRateErr, paramLErr, paramPErr, runTimeErr);
+	std::stringstream note;
+	note << std::scientific << std::setprecision(1) << "# budget expired for alphabet size " << alphabetSize;
+	note << ": codeRate +-" << codeRateErr << " paramL +-" << paramLErr << " paramP +-" << paramPErr;
+	note << " runtime(log 2) +-" << runTimeErr;
+	return note.str();
+}
+
+// Comment line following the row of an alphabet size evaluated by the
+// large-alphabet solver with the estimated errors of its surface areas and of
+// the running time, which combines at most four surface areas with
+// coefficients below one, scaled by log2(alphabetSize).
+std::string AsymptoticNote(unsigned int alphabetSize, double asymptoticError)
+{
+	if (!UsesAsymptotic(alphabetSize))
+		return "";
+
+	std::stringstream note;
+	note << std::scientific << std::setprecision(1) << "# asymptotic evaluation for alphabet size " << alphabetSize;
+	note << ": estimated error surface area +-" << asymptoticError << " runtime(log 2) +-";
+	note << 4 * log2(alphabetSize) * asymptoticError;
+	return note.str();
+}
+
+// Items in the order of the rows of the results files: by metric, algorithm,
+// regime and then alphabet size.
+std::vector<SweepItem> SweepItems(const std::vector<std::string>& metrics, const std::vector<std::string>& algorithms,
+	const std::vector<std::string>& regimes, const std::vector<unsigned int>& alphabetSizes)
+{
+	std::vector<SweepItem> items;
+	for (auto m = 0; m < metrics.size(); m++)
+		for (auto a = 0; a < algorithms.size(); a++)
+			for (auto r = 0; r < regimes.size(); r++)
+				for (auto i = 0; i < alphabetSizes.size(); i++)
+				{
+					SweepItem item;
+					item.metric = metrics[m];
+					item.algorithm = algorithms[a];
+					item.regime = regimes[r];
+					item.alphabetSize = alphabetSizes[i];
+					items.push_back(item);
+				}
+	return items;
+}
+
+static std::string ReadFile(const std::string& filename)
+{
+	std::ifstream inputFile(filename);
+	std::stringstream ss;
+	ss << inputFile.rdbuf();
+	return ss.str();
+}
+
+// The manifest sweep.txt of the work directory lists the items of the sweep,
+// so that every shard checks it works on the same sweep and the merge knows
+// every row it has to write. It is written to a temporary file and renamed,
+// so that other shards never read it half-written.
+static void WriteManifest(const std::vector<SweepItem>& items, const std::string& dir)
+{
+	std::stringstream manifest;
+	for (auto i = 0; i < items.size(); i++)
+	{
+		manifest << i << " " << items[i].metric << " " << items[i].algorithm << " " << items[i].regime;
+		manifest << " " << items[i].alphabetSize << std::endl;
+	}
+
+	if (mkdir(dir.c_str(), 0755) && errno != EEXIST)
+		throw std::runtime_error("Work directory " + dir + " cannot be created.");
+
+	std::string filename = dir + "/sweep.txt";
+	if (!access(filename.c_str(), F_OK))
+	{
+		if (ReadFile(filename).compare(manifest.str()))
+			throw std::invalid_argument("Work directory " + dir + " holds a different sweep.");
+		return;
+	}
+
+	std::string tmpFilename = filename + "." + std::to_string(getpid());
+	std::ofstream outputFile(tmpFilename, std::ofstream::trunc);
+	outputFile << manifest.str();
+	outputFile.close();
+	if (!outputFile || rename(tmpFilename.c_str(), filename.c_str()))
+		throw std::runtime_error("Manifest " + filename + " cannot be written.");
+}
+
+static std::vector<SweepItem> ReadManifest(const std::string& dir)
+{
+	std::ifstream inputFile(dir + "/sweep.txt");
+	if (!inputFile)
+		throw std::invalid_argument("Work directory " + dir + " holds no sweep.");
+
+	std::vector<SweepItem> items;
+	unsigned int index;
+	SweepItem item;
+	while (inputFile >> index >> item.metric >> item.algorithm >> item.regime >> item.alphabetSize)
+	{
+		if (index != items.size())
+			throw std::invalid_argument("Manifest of " + dir + " is corrupted.");
+		items.push_back(item);
+	}
+	return items;
+}
+
+// Lock file of an item of the work directory.
+static std::string LockFilename(const std::string& dir, unsigned int index)
+{
+	return dir + "/item_" + std::to_string(index) + ".lock";
+}
+
+// An item belongs to the shard that first creates its lock file: O_EXCL makes
+// the creation atomic, also on a shared filesystem. The lock file of a failed
+// item is removed (see ReleaseItem); that of an item interrupted by a crash
+// stays, so such an item is rerun only after its lock file is deleted by hand.
+static bool ClaimItem(const std::string& dir, unsigned int index, unsigned int shard)
+{
+	std::string filename = LockFilename(dir, index);
+	int fd = open(filename.c_str(), O_CREAT | O_EXCL | O_WRONLY, 0644);
+	if (fd < 0)
+	{
+		if (errno == EEXIST)
+			return false;
+		throw std::runtime_error("Lock file " + filename + " cannot be created.");
+	}
+
+	std::string owner = "shard " + std::to_string(shard) + ", pid " + std::to_string(getpid()) + "\n";
+	bool written = write(fd, owner.data(), owner.size()) == owner.size();
+	close(fd);
+	if (!written)
+		throw std::runtime_error("Lock file " + filename + " cannot be written.");
+	return true;
+}
+
+// Gives up the claim of a failed item, so that the shards that reach it later,
+// or a rerun of this one, search it again.
+static void ReleaseItem(const std::string& dir, unsigned int index)
+{
+	std::string filename = LockFilename(dir, index);
+	if (unlink(filename.c_str()) && errno != ENOENT)
+		throw std::runtime_error("Lock file " + filename + " cannot be removed.");
+}
+
+// Searches every item of the sweep that no other shard has claimed and appends
+// its results at full precision to shard_<shard>.txt of the work directory:
+// "<index> row <codeRate> <weight> <optLevelNum> <paramL> <paramP> <runtime>",
+// followed by "<index> note <comment line>" for its comment lines, or a single
+// "<index> failed <reason>". Shards start at evenly spread items and then
+// claim the remaining ones in order, so they rarely compete for the same item.
+void RunShard(const std::vector<SweepItem>& items, unsigned int shard, unsigned int shardsNum, const std::string& dir,
+	const SweepBudget& budget, std::ostream& out)
+{
+	WriteManifest(items, dir);
+	std::ofstream shardFile(dir + "/shard_" + std::to_string(shard) + ".txt", std::ios_base::app);
+	if (!shardFile)
+		throw std::runtime_error("Shard file of shard " + std::to_string(shard) + " cannot be opened.");
+
+	std::map<std::string, double> asymptoticErrors;
+	unsigned int first = items.size() * shard / shardsNum;
+	for (auto k = 0; k < items.size(); k++)
+	{
+		unsigned int index = (first + k) % items.size();
+		if (!ClaimItem(dir, index, shard))
+			continue;
+
+		const SweepItem& item = items[index];
+		out << "Shard " << shard << "/" << shardsNum << " processing " << item.metric << " " << item.algorithm;
+		out << " " << item.regime << ", alphabet size: " << item.alphabetSize << std::endl;
+
+		double paramL, paramP, weight, codeRate, runTime;
+		unsigned int optLevelNum;
+		quantum = !item.regime.compare("quantum");
+		costModelEvals = 0;
+		try
+		{
+			if (UsesAsymptotic(item.alphabetSize) && !asymptoticErrors.count(item.metric))
+				asymptoticErrors[item.metric] = AsymptoticErrorEstimate(item.metric, 257);
+
+			searchProgress.Start(budget.timeBudget, budget.evalBudget, budget.progressInterval, out);
+			runTime = HardestInstance(item.metric, item.algorithm, item.alphabetSize, codeRate, weight, paramL, paramP,
+				optLevelNum);
+			searchProgress.Stop();
+		}
+		catch (std::exception& e)
+		{
+			searchProgress.Stop();
+			shardFile << index << " failed " << e.what() << std::endl;
+			out << e.what() << std::endl;
+			ReleaseItem(dir, index);
+			continue;
+		}
+
+		shardFile << std::setprecision(17) << index << " row " << codeRate << " " << weight << " " << optLevelNum;
+		shardFile << " " << paramL << " " << paramP << " " << -runTime << std::endl;
+		std::string notes[] = { BudgetNote(item.alphabetSize),
+			AsymptoticNote(item.alphabetSize, asymptoticErrors[item.metric]) };
+		for (auto i = 0; i < 2; i++)
+		{
+			if (!notes[i].empty())
+				shardFile << index << " note " << notes[i] << std::endl;
+		}
+		shardFile.flush();
+		out << "Cost-model evaluations: " << costModelEvals << std::endl;
+	}
+}
+
+// Rows and comment lines of one item read from a shard file.
+struct ShardRecord
+{
+	bool found;
+	double codeRate, weight, paramL, paramP, runTime;
+	unsigned int optLevelNum;
+	std::vector<std::string> notes;
+	std::string failure;
+	ShardRecord() : found(false) {}
+};
+
+// Writes the results of every metric and algorithm of the sweep to
+// <metric>_<algorithm>/results.txt and results_quantum.txt, in the layout and
+// row order of the interactive run. An item searched by several shards (after
+// its lock file was removed) is taken from the shard with the lowest index.
+void MergeShards(const std::string& dir, std::ostream& out)
+{
+	std::vector<SweepItem> items = ReadManifest(dir);
+
+	std::vector<unsigned int> shards;
+	DIR* d = opendir(dir.c_str());
+	if (!d)
+		throw std::invalid_argument("Work directory " + dir + " cannot be opened.");
+	while (struct dirent* entry = readdir(d))
+	{
+		unsigned int shard;
+		if (sscanf(entry->d_name, "shard_%u", &shard) == 1
+			&& !std::string(entry->d_name).compare("shard_" + std::to_string(shard) + ".txt"))
+			shards.push_back(shard);
+	}
+	closedir(d);
+	std::sort(shards.begin(), shards.end());
+
+	std::vector<ShardRecord> records(items.size());
+	for (auto s = 0; s < shards.size(); s++)
+	{
+		std::ifstream shardFile(dir + "/shard_" + std::to_string(shards[s]) + ".txt");
+		std::set<unsigned int> taken;
+		std::string line;
+		while (std::getline(shardFile, line))
+		{
+			std::istringstream ss(line);
+			unsigned int index;
+			std::string kind;
+			if (!(ss >> index >> kind) || index >= items.size())
+				continue;
+
+			ShardRecord& record = records[index];
+			if (!kind.compare("row") && !record.found)
+			{
+				ss >> record.codeRate >> record.weight >> record.optLevelNum >> record.paramL >> record.paramP;
+				ss >> record.runTime;
+				record.found = bool(ss);
+				if (record.found)
+					taken.insert(index);
+			}
+			else if (!kind.compare("note") && taken.count(index))
+			{
+				std::string note;
+				std::getline(ss >> std::ws, note);
+				record.notes.push_back(note);
+			}
+			else if (!kind.compare("failed") && !record.found)
+			{
+				std::getline(ss >> std::ws, record.failure);
+			}
+		}
+	}
+
+	unsigned int missing = 0;
+	for (auto i = 0; i < items.size(); i++)
+	{
+		if (records[i].found)
+			continue;
+		out << "Missing " << items[i].metric << " " << items[i].algorithm << " " << items[i].regime;
+		out << ", alphabet size " << items[i].alphabetSize;
+		out << (records[i].failure.empty() ? "" : ": " + records[i].failure) << std::endl;
+		missing++;
+	}
+	if (missing)
+		throw std::runtime_error(std::to_string(missing) + " of " + std::to_string(items.size())
+			+ " items have no results.");
+
+	std::set<std::string> written;
+	for (auto i = 0; i < items.size(); i++)
+	{
+		std::string subdir = items[i].metric + "_" + items[i].algorithm;
+		std::string filename = subdir + (items[i].regime.compare("quantum") ? "/results.txt" : "/results_quantum.txt");
+		std::ofstream outputFile;
+		if (written.insert(filename).second)
+		{
+			if (mkdir(subdir.c_str(), 0755) && errno != EEXIST)
+				throw std::runtime_error("Directory " + subdir + " cannot be created.");
+			outputFile.open(filename, std::ofstream::trunc);
+			WriteResultsHeader(outputFile);
+			out << "Writing " << filename << std::endl;
+		}
+		else
+		{
+			outputFile.open(filename, std::ios_base::app);
+		}
+
+		const ShardRecord& record = records[i];
+		WriteResultsRow(outputFile, items[i].alphabetSize, record.codeRate, record.weight, record.optLevelNum,
+			record.paramL, record.paramP, record.runTime);
+		for (auto n = 0; n < record.notes.size(); n++)
+		{
+			outputFile << record.notes[n] << std::endl;
+		}
+	}
+}
@@ -0,0 +1,35 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+// One hardest-instance search of a (metric, algorithm, regime, alphabet size) sweep.
+struct SweepItem
+{
+	std::string metric, algorithm, regime;
+	unsigned int alphabetSize;
+};
+
+// Budgets and reporting of the search of every item (see SearchProgress::Start).
+struct SweepBudget
+{
+	double timeBudget, progressInterval;
+	unsigned long long evalBudget;
+	SweepBudget(double t = 0, unsigned long long e = 0, double p = 0) : timeBudget(t), progressInterval(p),
+		evalBudget(e) {}
+};
+
+void WriteResultsHeader(std::ostream&);
+void WriteResultsRow(std::ostream&, unsigned int, double, double, unsigned int, double, double, double);
+std::string BudgetNote(unsigned int);
+std::string AsymptoticNote(unsigned int, double);
+
+std::vector<SweepItem> SweepItems(const std::vector<std::string>&, const std::vector<std::string>&,
+	const std::vector<std::string>&, const std::vector<unsigned int>&);
+void RunShard(const std::vector<SweepItem>&, unsigned int, unsigned int, const std::string&, const SweepBudget&,
+	std::ostream&);
+void MergeShards(const std::string&, std::ostream&);
+
+#endif